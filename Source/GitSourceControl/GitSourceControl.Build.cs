@@ -24,6 +24,7 @@ public class GitSourceControl : ModuleRules
 				"UnrealEd",
 				"SourceControl",
 				"Projects",
+				"Json",
 			}
 		);
 
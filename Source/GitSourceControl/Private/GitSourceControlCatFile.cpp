@@ -0,0 +1,277 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#include "GitSourceControlCatFile.h"
+
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "ISourceControlModule.h"
+#include "GitSourceControlUtils.h"
+
+namespace GitCatFileConstants
+{
+	/** Time without any output after which the Git process is considered stalled (smudge filters can download big Git LFS objects) */
+	const double StallTimeout = 60.0;
+}
+
+FGitCatFileBatch::FGitCatFileBatch(const bool bInCheckOnly)
+	: bCheckOnly(bInCheckOnly)
+{
+}
+
+FGitCatFileBatch::~FGitCatFileBatch()
+{
+	Stop();
+}
+
+void FGitCatFileBatch::Stop()
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	StopInternal();
+}
+
+void FGitCatFileBatch::StopInternal()
+{
+	if(Process.IsValid())
+	{
+		// Closing the standard input makes "cat-file --batch" exit, else it is terminated by the destructor
+		Process->CloseStdIn();
+		Process.Reset();
+	}
+	Buffer.Reset();
+	RepositoryRoot.Reset();
+}
+
+bool FGitCatFileBatch::EnsureRunning(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInWithFilters)
+{
+	if(Process.IsValid() && (RepositoryRoot != InRepositoryRoot || bWithFilters != bInWithFilters || !Process->IsRunning()))
+	{
+		StopInternal();
+	}
+
+	if(!Process.IsValid())
+	{
+		FString CommandLine = bCheckOnly ? TEXT("cat-file --batch-check") : TEXT("cat-file --batch");
+		if(bInWithFilters)
+		{
+			// Newer versions (2.11+) support smudge/clean filters used by Git LFS, git-fat, git-annex, etc
+			CommandLine += TEXT(" --filters");
+		}
+		UE_LOG(LogSourceControl, Log, TEXT("CatFileBatch: 'git %s'"), *CommandLine);
+
+		Process = MakeUnique<FGitProcess>();
+		const bool bWithStdIn = true;
+		if(!Process->Launch(InPathToGitBinary, InRepositoryRoot, CommandLine, bWithStdIn))
+		{
+			Process.Reset();
+			return false;
+		}
+		RepositoryRoot = InRepositoryRoot;
+		bWithFilters = bInWithFilters;
+	}
+
+	return true;
+}
+
+bool FGitCatFileBatch::ReadMore()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	while(!Process->ReadStdOut(Buffer))
+	{
+		// Also drain the standard error (warnings of smudge filters like Git LFS), else Git would block on a full pipe
+		LogStdErr();
+		if(!Process->IsRunning())
+		{
+			// last chance to get what has been written before exiting
+			return Process->ReadStdOut(Buffer);
+		}
+		if(FPlatformTime::Seconds() - StartTime > GitCatFileConstants::StallTimeout)
+		{
+			UE_LOG(LogSourceControl, Warning, TEXT("CatFileBatch: no answer from 'git cat-file' for %.0f seconds"), GitCatFileConstants::StallTimeout);
+			return false;
+		}
+		FPlatformProcess::Sleep(0.001f);
+	}
+	LogStdErr();
+	return true;
+}
+
+void FGitCatFileBatch::LogStdErr()
+{
+	const FString Errors = Process->ReadStdErr();
+	if(!Errors.IsEmpty())
+	{
+		UE_LOG(LogSourceControl, Warning, TEXT("CatFileBatch: %s"), *Errors.TrimEnd());
+	}
+}
+
+bool FGitCatFileBatch::ReadLine(FString& OutLine)
+{
+	int32 SearchFrom = 0;
+	int32 LineFeedIndex = INDEX_NONE;
+	while(true)
+	{
+		for(int32 Index = SearchFrom; Index < Buffer.Num(); Index++)
+		{
+			if(Buffer[Index] == '\n')
+			{
+				LineFeedIndex = Index;
+				break;
+			}
+		}
+		if(LineFeedIndex != INDEX_NONE)
+		{
+			break;
+		}
+		SearchFrom = Buffer.Num();
+		if(!ReadMore())
+		{
+			return false;
+		}
+	}
+
+	FUTF8ToTCHAR Line(reinterpret_cast<const ANSICHAR*>(Buffer.GetData()), LineFeedIndex);
+	OutLine = FString(Line.Length(), Line.Get());
+	Buffer.RemoveAt(0, LineFeedIndex + 1, false);
+	return true;
+}
+
+bool FGitCatFileBatch::ReadContent(const int64 InSize, TArray<uint8>& OutContent)
+{
+	if(InSize >= MAX_int32)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("CatFileBatch: blob too big (%lld bytes)"), InSize);
+		return false;
+	}
+	const int32 Size = static_cast<int32>(InSize);
+
+	// The content is followed by a line feed
+	while(Buffer.Num() < Size + 1)
+	{
+		if(!ReadMore())
+		{
+			return false;
+		}
+	}
+
+	if(Buffer.Num() == Size + 1)
+	{
+		// Usual case of a request waiting for its answer: just steal the buffer
+		OutContent = MoveTemp(Buffer);
+		OutContent.SetNum(Size, false);
+		Buffer.Reset();
+	}
+	else
+	{
+		OutContent.Reset(Size);
+		OutContent.Append(Buffer.GetData(), Size);
+		Buffer.RemoveAt(0, Size + 1, false);
+	}
+	return true;
+}
+
+/**
+ * Send a request and parse the header of the answer
+ *
+ * Example answers of "git cat-file --batch-check" (also the first line of the answer of "--batch", followed by the content of the object):
+f3137a7167c840847cd7bd2bf07eefbfb2d9bcd2 blob 70731
+97a4e7626681895e073aaefd68b8ac087db81b0b:Content/Blueprints/BP_Deleted.uasset missing
+*/
+bool FGitCatFileBatch::Request(const FString& InObjectName, FString& OutObjectId, FString& OutObjectType, int64& OutObjectSize)
+{
+	OutObjectId.Reset();
+	OutObjectType.Reset();
+	OutObjectSize = 0;
+
+	if(!Process->WriteStdIn(InObjectName + TEXT("\n")))
+	{
+		return false;
+	}
+
+	FString Header;
+	if(!ReadLine(Header))
+	{
+		return false;
+	}
+
+	if(Header.EndsWith(TEXT(" missing")) || Header.EndsWith(TEXT(" ambiguous")))
+	{
+		// Served, but the object does not exists (ie. file not present in this revision)
+		return true;
+	}
+
+	TArray<FString> Tokens;
+	Header.ParseIntoArray(Tokens, TEXT(" "), true);
+	if(Tokens.Num() != 3)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("CatFileBatch: unexpected answer '%s' for '%s'"), *Header, *InObjectName);
+		return false;
+	}
+
+	OutObjectId = MoveTemp(Tokens[0]);
+	OutObjectType = MoveTemp(Tokens[1]);
+	OutObjectSize = FCString::Atoi64(*Tokens[2]);
+	return true;
+}
+
+bool FGitCatFileBatch::GetObjectInfo(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InObjectName, FString& OutObjectId, FString& OutObjectType, int64& OutObjectSize)
+{
+	check(bCheckOnly);
+
+	FScopeLock ScopeLock(&CriticalSection);
+
+	if(!EnsureRunning(InPathToGitBinary, InRepositoryRoot, false))
+	{
+		return false;
+	}
+
+	const bool bServed = Request(InObjectName, OutObjectId, OutObjectType, OutObjectSize);
+	if(!bServed)
+	{
+		// Out of sync with the Git process: start over with a new one on next request
+		StopInternal();
+	}
+	return bServed;
+}
+
+bool FGitCatFileBatch::GetBlobContent(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInWithFilters, const FString& InObjectName, TArray<uint8>& OutContent)
+{
+	check(!bCheckOnly);
+
+	FScopeLock ScopeLock(&CriticalSection);
+
+	if(!EnsureRunning(InPathToGitBinary, InRepositoryRoot, bInWithFilters))
+	{
+		return false;
+	}
+
+	FString ObjectId;
+	FString ObjectType;
+	int64 ObjectSize = 0;
+	bool bServed = Request(InObjectName, ObjectId, ObjectType, ObjectSize);
+	if(bServed && !ObjectId.IsEmpty())
+	{
+		bServed = ReadContent(ObjectSize, OutContent);
+	}
+	if(!bServed)
+	{
+		// Out of sync with the Git process: start over with a new one on next request
+		StopInternal();
+		return false;
+	}
+
+	if(ObjectId.IsEmpty())
+	{
+		UE_LOG(LogSourceControl, Warning, TEXT("CatFileBatch: '%s' does not exist"), *InObjectName);
+		return false;
+	}
+	if(ObjectType != TEXT("blob"))
+	{
+		UE_LOG(LogSourceControl, Warning, TEXT("CatFileBatch: '%s' is a %s, not a blob"), *InObjectName, *ObjectType);
+		return false;
+	}
+	return true;
+}
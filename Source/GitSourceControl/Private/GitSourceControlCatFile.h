@@ -0,0 +1,99 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Templates/UniquePtr.h"
+
+class FGitProcess;
+
+/**
+ * Long-lived "git cat-file --batch" (or "--batch-check") process, owned by the provider,
+ * serving object lookups and blob contents through its standard input/output pipes.
+ *
+ * This avoids launching a new Git process for each revision of a file (diff against depot, history).
+ * The process is launched on first use, and relaunched if it exited or if the repository changed.
+ * Requests are serialized, so that it can be used from any worker thread.
+ */
+class FGitCatFileBatch
+{
+public:
+	/**
+	 * @param	bInCheckOnly		Only get the id, type and size of objects ("--batch-check"), not their content ("--batch")
+	 */
+	explicit FGitCatFileBatch(const bool bInCheckOnly);
+	~FGitCatFileBatch();
+
+	/** Stop the Git process, if running (it is launched again on next request) */
+	void Stop();
+
+	/**
+	 * Get the id, type and size of an object - "cat-file --batch-check"
+	 *
+	 * @param	InPathToGitBinary	The path to the Git binary
+	 * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
+	 * @param	InObjectName		The object to look for, ie. "<rev>:<path>" or a full SHA1
+	 * @param	OutObjectId			The full SHA1 of the object, or empty if the object does not exist
+	 * @param	OutObjectType		The type of the object ("blob", "tree", "commit"...)
+	 * @param	OutObjectSize		The size of the object (in bytes)
+	 * @returns true if the request was served (even if the object does not exist), false in case of error with the Git process
+	 */
+	bool GetObjectInfo(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InObjectName, FString& OutObjectId, FString& OutObjectType, int64& OutObjectSize);
+
+	/**
+	 * Get the content of a blob (file), with smudge filters applied (Git LFS...) if supported - "cat-file --batch --filters"
+	 *
+	 * @param	InPathToGitBinary	The path to the Git binary
+	 * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
+	 * @param	bInWithFilters		Use "--filters" to apply the smudge filters (requires Git 2.11+ and a "<rev>:<path>" object name)
+	 * @param	InObjectName		The object to look for, ie. "<rev>:<path>"
+	 * @param	OutContent			The binary content of the blob
+	 * @returns true if the content of the blob was read
+	 */
+	bool GetBlobContent(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInWithFilters, const FString& InObjectName, TArray<uint8>& OutContent);
+
+private:
+	/** Launch the Git process if not already running for this repository */
+	bool EnsureRunning(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInWithFilters);
+
+	/** Send a request and read the header line of the answer "<oid> <type> <size>" */
+	bool Request(const FString& InObjectName, FString& OutObjectId, FString& OutObjectType, int64& OutObjectSize);
+
+	/** Read more bytes from the process into the buffer, waiting for them if needed */
+	bool ReadMore();
+
+	/** Log the text available on the standard error of the process, if any (never blocks) */
+	void LogStdErr();
+
+	/** Read one line of text from the process */
+	bool ReadLine(FString& OutLine);
+
+	/** Read a number of bytes from the process (and the line feed that follows them) */
+	bool ReadContent(const int64 InSize, TArray<uint8>& OutContent);
+
+	/** Stop the Git process (with the critical section already held) */
+	void StopInternal();
+
+private:
+	/** Only get information about objects, not their content */
+	const bool bCheckOnly;
+
+	/** Serialize the requests from the different worker threads */
+	FCriticalSection CriticalSection;
+
+	/** The running Git process */
+	TUniquePtr<FGitProcess> Process;
+
+	/** The Git repository the process has been launched in */
+	FString RepositoryRoot;
+
+	/** Tells if the process has been launched with "--filters" */
+	bool bWithFilters = false;
+
+	/** Bytes read from the process but not consumed yet */
+	TArray<uint8> Buffer;
+};
@@ -6,17 +6,28 @@
 #include "GitSourceControlCommand.h"
 
 #include "Modules/ModuleManager.h"
+#include "Misc/ScopeLock.h"
 #include "GitSourceControlModule.h"
+#include "GitSourceControlUtils.h"
+
+/** Command executed by the current worker thread, see FGitSourceControlCommand::GetCurrentCommand() */
+static thread_local FGitSourceControlCommand* CurrentCommand = nullptr;
 
 FGitSourceControlCommand::FGitSourceControlCommand(const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation, const TSharedRef<class IGitSourceControlWorker, ESPMode::ThreadSafe>& InWorker, const FSourceControlOperationComplete& InOperationCompleteDelegate)
 	: Operation(InOperation)
 	, Worker(InWorker)
 	, OperationCompleteDelegate(InOperationCompleteDelegate)
+	, bOperationDetached(false)
 	, bExecuteProcessed(0)
+	, CompletedQueue(nullptr)
+	, ProcessedEvent(nullptr)
 	, bCommandSuccessful(false)
 	, bConnectionDropped(false)
+	, bTimedOut(false)
+	, Generation(0)
 	, bAutoDelete(true)
 	, Concurrency(EConcurrency::Synchronous)
+	, bCancelled(0)
 {
 	// grab the providers settings here, so we don't access them once the worker thread is launched
 	check(IsInGameThread());
@@ -28,15 +39,40 @@ FGitSourceControlCommand::FGitSourceControlCommand(const TSharedRef<class ISourc
 
 bool FGitSourceControlCommand::DoWork()
 {
-	bCommandSuccessful = Worker->Execute(*this);
-	FPlatformAtomics::InterlockedExchange(&bExecuteProcessed, 1);
+	CurrentCommand = this;
+	// a command cancelled before it started is not executed at all
+	bCommandSuccessful = !IsCancelled() && Worker->Execute(*this);
+	CurrentCommand = nullptr;
+	if (IsCancelled())
+	{
+		// whatever the worker managed to do before the cancellation, it was interrupted
+		bCommandSuccessful = false;
+		ErrorMessages.Add(TEXT("Operation cancelled"));
+	}
+	const bool bResult = bCommandSuccessful;
+	MarkProcessed();
 
-	return bCommandSuccessful;
+	// NOTE: the command can be deleted by the game thread as soon as it is in the completed queue
+	return bResult;
 }
 
 void FGitSourceControlCommand::Abandon()
+{
+	MarkProcessed();
+}
+
+void FGitSourceControlCommand::MarkProcessed()
 {
 	FPlatformAtomics::InterlockedExchange(&bExecuteProcessed, 1);
+	// NOTE: wake up a synchronous wait before handing over the command, since it can then be deleted along with its event
+	if (ProcessedEvent)
+	{
+		ProcessedEvent->Trigger();
+	}
+	if (CompletedQueue)
+	{
+		CompletedQueue->Enqueue(this);
+	}
 }
 
 void FGitSourceControlCommand::DoThreadedWork()
@@ -57,9 +93,160 @@ ECommandResult::Type FGitSourceControlCommand::ReturnResults()
 		Operation->AddErrorMessge(FText::FromString(String));
 	}
 
-	// run the completion delegate if we have one bound
+	// run the completion delegate if we have one bound (unless the operation was already completed, see DetachOperation())
 	ECommandResult::Type Result = bCommandSuccessful ? ECommandResult::Succeeded : ECommandResult::Failed;
-	OperationCompleteDelegate.ExecuteIfBound(Operation, Result);
+	if (!bOperationDetached)
+	{
+		OperationCompleteDelegate.ExecuteIfBound(Operation, Result);
+	}
+
+	// and the same for the operations merged into this command, with their own results if any
+	for (FGitMergedOperation& MergedOperation : MergedOperations)
+	{
+		if (MergedOperation.bDetached)
+		{
+			continue;
+		}
+		for (FString& String : MergedOperation.bOwnResult ? MergedOperation.InfoMessages : InfoMessages)
+		{
+			MergedOperation.Operation->AddInfoMessge(FText::FromString(String));
+		}
+		for (FString& String : MergedOperation.bOwnResult ? MergedOperation.ErrorMessages : ErrorMessages)
+		{
+			MergedOperation.Operation->AddErrorMessge(FText::FromString(String));
+		}
+		const ECommandResult::Type MergedResult = MergedOperation.bOwnResult ? (MergedOperation.bSuccessful ? ECommandResult::Succeeded : ECommandResult::Failed) : Result;
+		MergedOperation.OperationCompleteDelegate.ExecuteIfBound(MergedOperation.Operation, MergedResult);
+	}
 
 	return Result;
 }
+
+void FGitSourceControlCommand::Merge(FGitSourceControlCommand& InOther)
+{
+	if (MergedOperations.Num() == 0)
+	{
+		OperationFiles = Files;
+	}
+
+	TSet<FString> UniqueFiles(Files);
+	for (const FString& File : InOther.Files)
+	{
+		if (!UniqueFiles.Contains(File))
+		{
+			UniqueFiles.Add(File);
+			Files.Add(File);
+		}
+	}
+
+	MergedOperations.Emplace(InOther.Operation, InOther.OperationCompleteDelegate, (InOther.MergedOperations.Num() > 0) ? InOther.OperationFiles : InOther.Files);
+	MergedOperations.Append(MoveTemp(InOther.MergedOperations));
+	InOther.OperationCompleteDelegate.Unbind();
+}
+
+bool FGitSourceControlCommand::HasOperation(const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation) const
+{
+	if (Operation == InOperation)
+	{
+		return !bOperationDetached;
+	}
+	return MergedOperations.ContainsByPredicate([&InOperation](const FGitMergedOperation& InMergedOperation)
+	{
+		return (InMergedOperation.Operation == InOperation) && !InMergedOperation.bDetached;
+	});
+}
+
+int32 FGitSourceControlCommand::GetNumOperations() const
+{
+	int32 NumOperations = bOperationDetached ? 0 : 1;
+	for (const FGitMergedOperation& MergedOperation : MergedOperations)
+	{
+		if (!MergedOperation.bDetached)
+		{
+			++NumOperations;
+		}
+	}
+	return NumOperations;
+}
+
+void FGitSourceControlCommand::DetachOperation(const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation, const bool bInIssued)
+{
+	check(IsInGameThread());
+
+	FSourceControlOperationComplete DetachedOperationCompleteDelegate;
+	if (Operation == InOperation)
+	{
+		bOperationDetached = true;
+		DetachedOperationCompleteDelegate = MoveTemp(OperationCompleteDelegate);
+		OperationCompleteDelegate.Unbind();
+	}
+	for (FGitMergedOperation& MergedOperation : MergedOperations)
+	{
+		if (MergedOperation.Operation == InOperation)
+		{
+			MergedOperation.bDetached = true;
+			DetachedOperationCompleteDelegate = MoveTemp(MergedOperation.OperationCompleteDelegate);
+			MergedOperation.OperationCompleteDelegate.Unbind();
+		}
+	}
+
+	// Only run for the files of the remaining operations, unless a worker thread could already be reading them
+	if (!bInIssued)
+	{
+		TSet<FString> RemainingFiles;
+		if (!bOperationDetached)
+		{
+			RemainingFiles.Append(OperationFiles);
+		}
+		for (const FGitMergedOperation& MergedOperation : MergedOperations)
+		{
+			if (!MergedOperation.bDetached)
+			{
+				RemainingFiles.Append(MergedOperation.Files);
+			}
+		}
+		Files.RemoveAll([&RemainingFiles](const FString& InFile) { return !RemainingFiles.Contains(InFile); });
+	}
+
+	// NOTE: last, since the delegate could issue other operations, merged into this command
+	InOperation->AddErrorMessge(FText::FromString(TEXT("Operation cancelled")));
+	DetachedOperationCompleteDelegate.ExecuteIfBound(InOperation, ECommandResult::Failed);
+}
+
+void FGitSourceControlCommand::Cancel()
+{
+	// NOTE: set the flag before terminating the processes, so that a process registered concurrently is terminated by AddRunningProcess()
+	FPlatformAtomics::InterlockedExchange(&bCancelled, 1);
+
+	FScopeLock ScopeLock(&RunningProcessesCriticalSection);
+	for (FGitProcess* Process : RunningProcesses)
+	{
+		Process->Terminate();
+	}
+}
+
+FGitSourceControlCommand* FGitSourceControlCommand::GetCurrentCommand()
+{
+	return CurrentCommand;
+}
+
+bool FGitSourceControlCommand::IsCurrentCommandInterrupted()
+{
+	return (CurrentCommand != nullptr) && (CurrentCommand->IsCancelled() || CurrentCommand->bTimedOut);
+}
+
+void FGitSourceControlCommand::AddRunningProcess(FGitProcess& InProcess)
+{
+	FScopeLock ScopeLock(&RunningProcessesCriticalSection);
+	RunningProcesses.Add(&InProcess);
+	if (IsCancelled())
+	{
+		InProcess.Terminate();
+	}
+}
+
+void FGitSourceControlCommand::RemoveRunningProcess(FGitProcess& InProcess)
+{
+	FScopeLock ScopeLock(&RunningProcessesCriticalSection);
+	RunningProcesses.RemoveSingleSwap(&InProcess, false);
+}
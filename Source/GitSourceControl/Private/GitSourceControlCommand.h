@@ -8,6 +8,42 @@
 #include "CoreMinimal.h"
 #include "ISourceControlProvider.h"
 #include "Misc/IQueuedWork.h"
+#include "Containers/Queue.h"
+#include "HAL/Event.h"
+#include "HAL/CriticalSection.h"
+
+class FGitSourceControlCommand;
+class FGitProcess;
+
+/** Queue of the commands completed by the worker threads, drained by the game thread (see FGitSourceControlProvider::Tick()) */
+typedef TQueue<FGitSourceControlCommand*, EQueueMode::Mpsc> FGitCompletedCommandQueue;
+
+/** Operation of another command merged into a command (see FGitSourceControlCommand::Merge()) */
+struct FGitMergedOperation
+{
+	FGitMergedOperation(const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation, const FSourceControlOperationComplete& InOperationCompleteDelegate, const TArray<FString>& InFiles)
+		: Operation(InOperation)
+		, OperationCompleteDelegate(InOperationCompleteDelegate)
+		, Files(InFiles)
+	{
+	}
+
+	/** The operation, and its delegate to notify when the command completes */
+	TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe> Operation;
+	FSourceControlOperationComplete OperationCompleteDelegate;
+
+	/** Files of the operation */
+	TArray<FString> Files;
+
+	/** If true, the operation was cancelled and already completed, while the command keeps running for the other ones (see FGitSourceControlCommand::DetachOperation()) */
+	bool bDetached = false;
+
+	/** If true, the worker gave the operation its own result and messages below, instead of those of the whole command */
+	bool bOwnResult = false;
+	bool bSuccessful = false;
+	TArray<FString> InfoMessages;
+	TArray<FString> ErrorMessages;
+};
 
 /**
  * Used to execute Git commands multi-threaded.
@@ -41,6 +77,64 @@ public:
 	/** Save any results and call any registered callbacks. */
 	ECommandResult::Type ReturnResults();
 
+	/**
+	 * Merge another command not started yet into this one (also not started): run once for the files of both,
+	 * and then return the results to the operations of both. The other command can then be deleted.
+	 */
+	void Merge(FGitSourceControlCommand& InOther);
+
+	/** Tells if the command runs the given operation, either its own one or a merged one, not detached */
+	bool HasOperation(const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation) const;
+
+	/** Get the number of operations of the command, its own one and the merged ones, not detached */
+	int32 GetNumOperations() const;
+
+	/**
+	 * Complete one of the operations of the command right away as cancelled, from the game thread, while the command keeps running for the other ones.
+	 * The files of the operation are also removed from the command if it was not issued yet, and if no other operation has them.
+	 *
+	 * @param	InOperation		The operation to detach
+	 * @param	bInIssued		Tells if the command was issued to the worker threads, which could be reading its files
+	 */
+	void DetachOperation(const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation, const bool bInIssued);
+
+	/**
+	 * Request the cancellation of the command, from any thread: the Git processes it is running are terminated (with their child processes),
+	 * and it does not start any other one, so that it fails as soon as possible (or right away if it did not start yet).
+	 */
+	void Cancel();
+
+	/** Tells if the cancellation of the command was requested */
+	bool IsCancelled() const
+	{
+		return bCancelled != 0;
+	}
+
+	/** Get the command executed by the current worker thread, if any, to check for its cancellation from the Git helpers */
+	static FGitSourceControlCommand* GetCurrentCommand();
+
+	/** Tells if the command executed by the current thread, if any, is cancelled or timed out: no more Git process should be launched for it */
+	static bool IsCurrentCommandInterrupted();
+
+	/** Register a Git process launched by the command, to terminate it on cancellation (right away if already cancelled) */
+	void AddRunningProcess(FGitProcess& InProcess);
+
+	/** Unregister a Git process of the command, before destroying it */
+	void RemoveRunningProcess(FGitProcess& InProcess);
+
+private:
+	/** Flag the command as processed, and hand it over to the game thread through the completed queue */
+	void MarkProcessed();
+
+	/** If true, the cancellation of the command was requested (see Cancel()) */
+	volatile int32 bCancelled;
+
+	/** Git processes currently run by the command, to terminate on cancellation */
+	TArray<FGitProcess*> RunningProcesses;
+
+	/** Critical section for thread safety of the running processes */
+	FCriticalSection RunningProcessesCriticalSection;
+
 public:
 	/** Path to the Git binary */
 	FString PathToGitBinary;
@@ -60,15 +154,36 @@ public:
 	/** Delegate to notify when this operation completes */
 	FSourceControlOperationComplete OperationCompleteDelegate;
 
+	/** If true, the operation of the command itself was cancelled and already completed, while the command keeps running for the merged ones */
+	bool bOperationDetached;
+
+	/** Operations of the commands merged into this one, with their delegates, to also notify when this operation completes */
+	TArray<FGitMergedOperation> MergedOperations;
+
+	/** Files of the operation of this command itself, before other operations were merged into it (empty if none) */
+	TArray<FString> OperationFiles;
+
 	/**If true, this command has been processed by the source control thread*/
 	volatile int32 bExecuteProcessed;
 
+	/** Queue to which the command adds itself once processed, if any */
+	FGitCompletedCommandQueue* CompletedQueue;
+
+	/** Event triggered once processed, for a synchronous command to wait for it (see ExecuteSynchronousCommand()) */
+	FEvent* ProcessedEvent;
+
 	/**If true, the source control command succeeded*/
 	bool bCommandSuccessful;
 
 	/** TODO LFS If true, the source control connection was dropped while this command was being executed*/
 	bool bConnectionDropped;
 
+	/** If true, a Git process of the command was terminated for running past its timeout, and the remaining ones were skipped */
+	bool bTimedOut;
+
+	/** Generation of the command, increasing in the order the commands are issued, given to the states it produces (see FGitSourceControlStateCache::Update()) */
+	uint32 Generation;
+
 	/** Current Commit full SHA1 */
 	FString CommitId;
 
@@ -19,11 +19,35 @@ void FGitSourceControlConsole::Register()
 			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FGitSourceControlConsole::ExecuteGitConsoleCommand)
 		);
 	}
+	if (!SchedulerStatsCommand.IsValid())
+	{
+		SchedulerStatsCommand = MakeUnique<FAutoConsoleCommand>(
+			TEXT("git.SchedulerStats"),
+			TEXT("Log the queue depth and wait times of the source control commands, by priority class."),
+			FConsoleCommandDelegate::CreateRaw(this, &FGitSourceControlConsole::ExecuteSchedulerStatsCommand)
+		);
+	}
 }
 
 void FGitSourceControlConsole::Unregister()
 {
 	GitConsoleCommand.Reset();
+	SchedulerStatsCommand.Reset();
+}
+
+void FGitSourceControlConsole::ExecuteSchedulerStatsCommand()
+{
+	static const TCHAR* PriorityNames[EGitCommandPriority::Count] = { TEXT("Interactive"), TEXT("Bulk"), TEXT("Background") };
+
+	const FGitSourceControlModule& GitSourceControl = FModuleManager::LoadModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	const FGitSchedulerStats Stats = GitSourceControl.GetProvider().GetSchedulerStats();
+
+	UE_LOG(LogSourceControl, Log, TEXT("Worker threads: %d (%d running)"), Stats.NumWorkers, Stats.NumRunning);
+	for (uint32 Priority = 0; Priority < EGitCommandPriority::Count; ++Priority)
+	{
+		UE_LOG(LogSourceControl, Log, TEXT("%s: %d queued, %d started, wait time %.3fs average, %.3fs max"),
+			PriorityNames[Priority], Stats.QueueDepth[Priority], Stats.NumStarted[Priority], Stats.AverageWaitTime[Priority], Stats.MaxWaitTime[Priority]);
+	}
 }
 
 void FGitSourceControlConsole::ExecuteGitConsoleCommand(const TArray<FString>& a_args)
@@ -21,6 +21,12 @@ private:
 	// Git Command Line Interface: Run 'git' commands directly from the Unreal Editor Console.
 	void ExecuteGitConsoleCommand(const TArray<FString>& a_args);
 
+	// Log the statistics of the worker threads executing the source control commands.
+	void ExecuteSchedulerStatsCommand();
+
 	/** Console command for interacting with 'git' CLI directly */
 	TUniquePtr<FAutoConsoleCommand> GitConsoleCommand;
+
+	/** Console command to log the statistics of the worker threads */
+	TUniquePtr<FAutoConsoleCommand> SchedulerStatsCommand;
 };
\ No newline at end of file
@@ -0,0 +1,309 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#include "GitSourceControlLfsLocks.h"
+
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "ISourceControlModule.h"
+#include "GitSourceControlModule.h"
+#include "GitSourceControlUtils.h"
+
+FGitLfsLockCache::~FGitLfsLockCache()
+{
+	Stop();
+}
+
+void FGitLfsLockCache::Stop()
+{
+	TFuture<void> Refresh;
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		Refresh = MoveTemp(BackgroundRefresh);
+	}
+	if(Refresh.IsValid())
+	{
+		Refresh.Wait();
+	}
+
+	FScopeLock ScopeLock(&CriticalSection);
+	RepositoryRoot.Reset();
+	Locks.Reset();
+	PendingDeltas.Reset();
+	LastErrorMessages.Reset();
+	ChangedLocks.Reset();
+	LastRefreshTime = 0.0;
+	LastBackgroundRefreshTime = 0.0;
+	bFilled = false;
+}
+
+/**
+ * Parse the locks of a "git lfs locks --json" command
+ *
+ * Example output of "git lfs locks --json" (on one line):
+[{"id":"891","path":"Content/ThirdPersonBP/Blueprints/ThirdPersonCharacter.uasset","owner":{"name":"SRombauts"},"locked_at":"2022-05-30T18:49:11Z"},
+ {"id":"896","path":"Content/ThirdPersonBP/Blueprints/ThirdPersonGameMode.uasset","owner":{"name":"SRombauts"},"locked_at":"2022-05-30T18:49:12Z"}]
+ */
+bool FGitLfsLockCache::ReadLocks(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInLocal, TMap<FString, FString>& OutLocks, TArray<FString>& OutErrorMessages)
+{
+	FString Results;
+	FString Errors;
+	TArray<FString> Parameters;
+	Parameters.Add(TEXT("--json"));
+	if(bInLocal)
+	{
+		Parameters.Add(TEXT("--local")); // locks cached by Git LFS, without contacting the server
+	}
+	const bool bResult = GitSourceControlUtils::RunCommandInternalRaw(TEXT("lfs locks"), InPathToGitBinary, InRepositoryRoot, Parameters, TArray<FString>(), Results, Errors);
+	if(!bResult)
+	{
+		Errors.ParseIntoArray(OutErrorMessages, TEXT("\n"), true);
+		return false;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> JsonLocks;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Results);
+	if(!FJsonSerializer::Deserialize(Reader, JsonLocks))
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to parse the Git LFS locks: '%s'"), *Results);
+		OutErrorMessages.Add(TEXT("Failed to parse the Git LFS locks"));
+		return false;
+	}
+
+	OutLocks.Reserve(JsonLocks.Num());
+	for(const TSharedPtr<FJsonValue>& JsonLock : JsonLocks)
+	{
+		const TSharedPtr<FJsonObject>* Lock = nullptr;
+		FString Path;
+		const TSharedPtr<FJsonObject>* Owner = nullptr;
+		FString OwnerName;
+		if(JsonLock.IsValid() && JsonLock->TryGetObject(Lock) && (*Lock)->TryGetStringField(TEXT("path"), Path))
+		{
+			if((*Lock)->TryGetObjectField(TEXT("owner"), Owner))
+			{
+				(*Owner)->TryGetStringField(TEXT("name"), OwnerName);
+			}
+			OutLocks.Add(MoveTemp(Path), MoveTemp(OwnerName));
+		}
+	}
+	UE_LOG(LogSourceControl, Log, TEXT("ReadLocks: %d locks%s"), OutLocks.Num(), bInLocal ? TEXT(" (local)") : TEXT(""));
+
+	return true;
+}
+
+void FGitLfsLockCache::SetRepositoryRoot(const FString& InRepositoryRoot)
+{
+	if(RepositoryRoot != InRepositoryRoot)
+	{
+		Locks.Reset();
+		LastErrorMessages.Reset();
+		ChangedLocks.Reset();
+		LastRefreshTime = 0.0;
+		LastBackgroundRefreshTime = 0.0;
+		bFilled = false;
+		RepositoryRoot = InRepositoryRoot;
+	}
+}
+
+void FGitLfsLockCache::BeginRefresh()
+{
+	RefreshesInProgress++;
+}
+
+void FGitLfsLockCache::EndRefresh(TMap<FString, FString>&& InLocks, const bool bInSucceeded, const bool bInFromServer, const TArray<FString>& InErrorMessages)
+{
+	if(bInFromServer)
+	{
+		LastErrorMessages.Reset();
+		if(!bInSucceeded)
+		{
+			LastErrorMessages = InErrorMessages;
+			if(LastErrorMessages.Num() == 0)
+			{
+				LastErrorMessages.Add(TEXT("Failed to get the Git LFS locks from the server"));
+			}
+		}
+	}
+
+	// Never replace an answer of the server by the partial one of the local cache of Git LFS
+	if(bInSucceeded && (bInFromServer || LastRefreshTime == 0.0))
+	{
+		TMap<FString, FString> PreviousLocks = MoveTemp(Locks);
+		Locks = MoveTemp(InLocks);
+		for(const auto& Delta : PendingDeltas)
+		{
+			ApplyDelta(Delta.Key, Delta.Value);
+		}
+		if(bFilled)
+		{
+			// Record the locks taken or released by others since the previous table (the first one is applied by the status of the files)
+			for(const auto& Lock : Locks)
+			{
+				const FString* PreviousOwner = PreviousLocks.Find(Lock.Key);
+				if(!PreviousOwner || (*PreviousOwner != Lock.Value))
+				{
+					ChangedLocks.Add(Lock.Key, Lock.Value);
+				}
+			}
+			for(const auto& PreviousLock : PreviousLocks)
+			{
+				if(!Locks.Contains(PreviousLock.Key))
+				{
+					ChangedLocks.Add(PreviousLock.Key, FString());
+				}
+			}
+		}
+		bFilled = true;
+		if(bInFromServer)
+		{
+			LastRefreshTime = FPlatformTime::Seconds();
+		}
+	}
+
+	RefreshesInProgress--;
+	if(RefreshesInProgress == 0)
+	{
+		PendingDeltas.Reset();
+	}
+}
+
+void FGitLfsLockCache::ApplyDelta(const FString& InRelativeFilename, const TOptional<FString>& InLockUser)
+{
+	if(InLockUser.IsSet())
+	{
+		Locks.Add(InRelativeFilename, InLockUser.GetValue());
+	}
+	else
+	{
+		Locks.Remove(InRelativeFilename);
+	}
+}
+
+bool FGitLfsLockCache::GetLocks(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInAbsolutePaths, TMap<FString, FString>& OutLocks, TArray<FString>& OutErrorMessages)
+{
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	const double TimeToLive = GitSourceControl.AccessSettings().GetLfsLocksCacheTTL();
+
+	bool bFillFromLocalCache = false;
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		SetRepositoryRoot(InRepositoryRoot);
+		bFillFromLocalCache = !bFilled;
+		if(bFillFromLocalCache)
+		{
+			BeginRefresh();
+		}
+	}
+
+	if(bFillFromLocalCache)
+	{
+		// Instant answer, while waiting for the one of the server
+		TMap<FString, FString> LocalLocks;
+		TArray<FString> ErrorMessages;
+		const bool bResult = ReadLocks(InPathToGitBinary, InRepositoryRoot, true, LocalLocks, ErrorMessages);
+		FScopeLock ScopeLock(&CriticalSection);
+		EndRefresh(MoveTemp(LocalLocks), bResult, false, ErrorMessages);
+		bFilled = true; // even if failed (ie. Git LFS without "--local"), the server will answer soon
+	}
+
+	FScopeLock ScopeLock(&CriticalSection);
+
+	const double Now = FPlatformTime::Seconds();
+	const bool bStale = (LastRefreshTime == 0.0) || (Now - LastRefreshTime > TimeToLive);
+	const bool bRefreshing = BackgroundRefresh.IsValid() && !BackgroundRefresh.IsReady();
+	const bool bRetryTooSoon = (LastBackgroundRefreshTime > 0.0) && (Now - LastBackgroundRefreshTime < FMath::Min(TimeToLive, 10.0));
+	if(bStale && !bRefreshing && !bRetryTooSoon)
+	{
+		UE_LOG(LogSourceControl, Log, TEXT("GetLocks: refresh from the server in the background"));
+		LastBackgroundRefreshTime = Now;
+		BeginRefresh();
+		const FString PathToGitBinary = InPathToGitBinary;
+		const FString PathToRepositoryRoot = InRepositoryRoot;
+		// On a thread of its own rather than on the thread pool of the engine, that would stay blocked as long as the server does not answer
+		BackgroundRefresh = Async(EAsyncExecution::Thread, [this, PathToGitBinary, PathToRepositoryRoot]()
+		{
+			TMap<FString, FString> ServerLocks;
+			TArray<FString> ErrorMessages;
+			const bool bResult = ReadLocks(PathToGitBinary, PathToRepositoryRoot, false, ServerLocks, ErrorMessages);
+			FScopeLock ScopeLock(&CriticalSection);
+			if(RepositoryRoot == PathToRepositoryRoot)
+			{
+				EndRefresh(MoveTemp(ServerLocks), bResult, true, ErrorMessages);
+			}
+			else
+			{
+				// answer for a previous repository: neither its locks nor its errors apply
+				EndRefresh(TMap<FString, FString>(), false, false, TArray<FString>());
+			}
+		});
+	}
+
+	OutLocks.Reserve(Locks.Num());
+	for(const auto& Lock : Locks)
+	{
+		if(bInAbsolutePaths)
+		{
+			OutLocks.Add(FPaths::ConvertRelativePathToFull(InRepositoryRoot, Lock.Key), Lock.Value);
+		}
+		else
+		{
+			OutLocks.Add(Lock.Key, Lock.Value);
+		}
+	}
+
+	OutErrorMessages.Append(LastErrorMessages);
+	return LastErrorMessages.Num() == 0;
+}
+
+bool FGitLfsLockCache::Refresh(const FString& InPathToGitBinary, const FString& InRepositoryRoot, TArray<FString>& OutErrorMessages)
+{
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		SetRepositoryRoot(InRepositoryRoot);
+		BeginRefresh();
+	}
+
+	TMap<FString, FString> ServerLocks;
+	const bool bResult = ReadLocks(InPathToGitBinary, InRepositoryRoot, false, ServerLocks, OutErrorMessages);
+
+	FScopeLock ScopeLock(&CriticalSection);
+	EndRefresh(MoveTemp(ServerLocks), bResult, true, OutErrorMessages);
+	return bResult;
+}
+
+void FGitLfsLockCache::OnLocked(const FString& InRelativeFilename, const FString& InLockUser)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	const TOptional<FString> LockUser(InLockUser);
+	ApplyDelta(InRelativeFilename, LockUser);
+	if(RefreshesInProgress > 0)
+	{
+		PendingDeltas.Add(InRelativeFilename, LockUser);
+	}
+}
+
+void FGitLfsLockCache::OnUnlocked(const FString& InRelativeFilename)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	const TOptional<FString> NoLockUser;
+	ApplyDelta(InRelativeFilename, NoLockUser);
+	if(RefreshesInProgress > 0)
+	{
+		PendingDeltas.Add(InRelativeFilename, NoLockUser);
+	}
+}
+
+void FGitLfsLockCache::TakeChangedLocks(TMap<FString, FString>& OutChangedLocks)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	OutChangedLocks = MoveTemp(ChangedLocks);
+	ChangedLocks.Reset();
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Async/Future.h"
+
+/**
+ * Table of the Git LFS locks of the repository, owned by the provider, so that status refreshes do not each ask the server for all the locks.
+ *
+ * The table is considered fresh for a configurable time (see FGitSourceControlSettings::GetLfsLocksCacheTTL()),
+ * then it is refreshed in the background with "git lfs locks --json" while the previous table is still used.
+ * Before the first answer of the server, "git lfs locks --local" gives an instant (partial) answer with the locks cached by Git LFS.
+ * Locks taken or released by our own commands are applied to the table right away.
+ */
+class FGitLfsLockCache
+{
+public:
+	~FGitLfsLockCache();
+
+	/** Wait for any refresh in progress, and forget all locks */
+	void Stop();
+
+	/**
+	 * Get all the locks of the repository, from the cache, starting a background refresh if they are not fresh anymore
+	 *
+	 * @param	InPathToGitBinary	The path to the Git binary
+	 * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
+	 * @param	bInAbsolutePaths	Whether to report absolute filenames, false for repo-relative
+	 * @param	OutLocks			The locks (filename, username)
+	 * @param	OutErrorMessages	The errors of the last refresh from the server, if it failed (the locks are then the ones of the previous answer, if any)
+	 * @returns false if the last refresh from the server failed
+	 */
+	bool GetLocks(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInAbsolutePaths, TMap<FString, FString>& OutLocks, TArray<FString>& OutErrorMessages);
+
+	/**
+	 * Refresh the locks from the server right away - "git lfs locks --json"
+	 *
+	 * @param	InPathToGitBinary	The path to the Git binary
+	 * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
+	 * @param	OutErrorMessages	Any errors (from StdErr) as an array per-line
+	 * @returns true if the command succeeded and returned no errors
+	 */
+	bool Refresh(const FString& InPathToGitBinary, const FString& InRepositoryRoot, TArray<FString>& OutErrorMessages);
+
+	/** Apply a lock taken by one of our commands ("git lfs lock") */
+	void OnLocked(const FString& InRelativeFilename, const FString& InLockUser);
+
+	/** Apply a lock released by one of our commands ("git lfs unlock") */
+	void OnUnlocked(const FString& InRelativeFilename);
+
+	/**
+	 * Take the locks changed by the refreshes since the last call, to apply them to the cached states (see FGitSourceControlProvider::Tick())
+	 * @param	OutChangedLocks		The changed locks, by repo-relative filename, with the name of their new owner (empty if released)
+	 */
+	void TakeChangedLocks(TMap<FString, FString>& OutChangedLocks);
+
+private:
+	/** Run "git lfs locks --json" (or "--local") and parse its results, by repo-relative filenames */
+	static bool ReadLocks(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInLocal, TMap<FString, FString>& OutLocks, TArray<FString>& OutErrorMessages);
+
+	/** Forget the locks of the previous repository, if any, with the critical section held */
+	void SetRepositoryRoot(const FString& InRepositoryRoot);
+
+	/** Start a refresh with the critical section held: record the changes made by our own commands until it ends */
+	void BeginRefresh();
+
+	/** End a refresh with the critical section held: replace the table (if succeeded), then replay the changes made by our own commands meanwhile */
+	void EndRefresh(TMap<FString, FString>&& InLocks, const bool bInSucceeded, const bool bInFromServer, const TArray<FString>& InErrorMessages);
+
+	/** Apply a lock or unlock with the critical section held */
+	void ApplyDelta(const FString& InRelativeFilename, const TOptional<FString>& InLockUser);
+
+private:
+	/** Critical section for thread safety of the table */
+	FCriticalSection CriticalSection;
+
+	/** The Git repository of the locks */
+	FString RepositoryRoot;
+
+	/** The locks, by repo-relative filename, with the name of their owner */
+	TMap<FString, FString> Locks;
+
+	/** Locks taken (with their owner) or released (unset) by our own commands while refreshes are in progress */
+	TMap<FString, TOptional<FString>> PendingDeltas;
+
+	/** Number of refreshes in progress */
+	int32 RefreshesInProgress = 0;
+
+	/** Time of the last complete answer of the server (FPlatformTime::Seconds()), or 0 if none */
+	double LastRefreshTime = 0.0;
+
+	/** Time of the start of the last background refresh, to not retry too often when the server does not answer */
+	double LastBackgroundRefreshTime = 0.0;
+
+	/** Tells if the table has been filled, either by the server or by the locks cached locally by Git LFS */
+	bool bFilled = false;
+
+	/** Errors of the last refresh from the server, if it failed */
+	TArray<FString> LastErrorMessages;
+
+	/** Locks changed by the refreshes, not taken yet (see TakeChangedLocks()), by repo-relative filename with their new owner (empty if released) */
+	TMap<FString, FString> ChangedLocks;
+
+	/** Refresh running in the background on its own thread, if any, joined by Stop() */
+	TFuture<void> BackgroundRefresh;
+};
@@ -27,7 +27,7 @@ Written and contributed by Sebastien Rombauts (sebastien.rombauts@gmail.com)
 - visual diff of a blueprint against depot or between previous versions of a file
 - revert modifications of a file
 - add, delete, rename a file
-- checkin/commit a file (cannot handle atomically more than 50 files)
+- checkin/commit a file (atomically with Git 2.26+ under UE5.1+, else by batches as big as the command line allows)
 - migrate an asset between two projects if both are using Git
 - solve a merge conflict on a blueprint
 - show current branch name in status text
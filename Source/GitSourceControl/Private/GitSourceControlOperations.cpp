@@ -46,7 +46,17 @@ bool FGitConnectWorker::Execute(FGitSourceControlCommand& InCommand)
 		TArray<FString> ProjectDirs;
 		ProjectDirs.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()));
 		ProjectDirs.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectConfigDir()));
-		InCommand.bCommandSuccessful = GitSourceControlUtils::RunUpdateStatus(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, InCommand.bUsingGitLfsLocking, ProjectDirs, InCommand.ErrorMessages, States);
+		FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+		TArray<FString> SnapshotFiles;
+		if(GitSourceControl.GetProvider().ConsumeStateSnapshot(SnapshotFiles))
+		{
+			// Warm start: the states of the previous session are already shown, only reconcile them with the files changed since
+			InCommand.bCommandSuccessful = GitSourceControlUtils::RunUpdateStatusChanges(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, InCommand.bUsingGitLfsLocking, ProjectDirs, SnapshotFiles, InCommand.ErrorMessages, States);
+		}
+		else
+		{
+			InCommand.bCommandSuccessful = GitSourceControlUtils::RunUpdateStatus(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, InCommand.bUsingGitLfsLocking, ProjectDirs, InCommand.ErrorMessages, States);
+		}
 		if(!InCommand.bCommandSuccessful || InCommand.ErrorMessages.Num() > 0)
 		{
 			Operation->SetErrorText(LOCTEXT("NotAGitRepository", "Failed to enable Git source control. You need to initialize the project as a Git repository first."));
@@ -58,8 +68,8 @@ bool FGitConnectWorker::Execute(FGitSourceControlCommand& InCommand)
 
 			if(InCommand.bUsingGitLfsLocking)
 			{
-				// Check server connection by checking lock status (when using Git LFS file Locking worflow)
-				InCommand.bCommandSuccessful = GitSourceControlUtils::RunCommand(TEXT("lfs locks"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), TArray<FString>(), InCommand.InfoMessages, InCommand.ErrorMessages);
+				// Check server connection by checking lock status (when using Git LFS file Locking worflow), filling the cache of locks
+				InCommand.bCommandSuccessful = GitSourceControl.GetProvider().GetLfsLockCache().Refresh(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, InCommand.ErrorMessages);
 			}
 		}
 	}
@@ -72,11 +82,16 @@ bool FGitConnectWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitConnectWorker::UpdateStates() const
+bool FGitConnectWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitConnectWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 FName FGitCheckOutWorker::GetName() const
 {
 	return "CheckOut";
@@ -89,13 +104,21 @@ bool FGitCheckOutWorker::Execute(FGitSourceControlCommand& InCommand)
 	if(InCommand.bUsingGitLfsLocking)
 	{
 		// lock files: execute the LFS command on relative filenames
+		FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+		FGitLfsLockCache& LfsLockCache = GitSourceControl.GetProvider().GetLfsLockCache();
+		const FString LfsUserName = GitSourceControl.AccessSettings().GetLfsUserName();
 		InCommand.bCommandSuccessful = true;
 		const TArray<FString> RelativeFiles = GitSourceControlUtils::RelativeFilenames(InCommand.Files, InCommand.PathToRepositoryRoot);
 		for(const auto& RelativeFile : RelativeFiles)
 		{
 			TArray<FString> OneFile;
 			OneFile.Add(RelativeFile);
-			InCommand.bCommandSuccessful &= GitSourceControlUtils::RunCommand(TEXT("lfs lock"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), OneFile, InCommand.InfoMessages, InCommand.ErrorMessages);
+			const bool bLocked = GitSourceControlUtils::RunCommand(TEXT("lfs lock"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), OneFile, InCommand.InfoMessages, InCommand.ErrorMessages);
+			if(bLocked)
+			{
+				LfsLockCache.OnLocked(RelativeFile, LfsUserName);
+			}
+			InCommand.bCommandSuccessful &= bLocked;
 		}
 
 		// now update the status of our files
@@ -109,11 +132,16 @@ bool FGitCheckOutWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitCheckOutWorker::UpdateStates() const
+bool FGitCheckOutWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitCheckOutWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 static FText ParseCommitResults(const TArray<FString>& InResults)
 {
 	if(InResults.Num() >= 1)
@@ -236,12 +264,17 @@ bool FGitCheckInWorker::Execute(FGitSourceControlCommand& InCommand)
 					const TArray<FString> LockedFiles = GetLockedFiles(InCommand.Files);
 					if(LockedFiles.Num() > 0)
 					{
+						FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+						FGitLfsLockCache& LfsLockCache = GitSourceControl.GetProvider().GetLfsLockCache();
 						const TArray<FString> RelativeFiles = GitSourceControlUtils::RelativeFilenames(LockedFiles, InCommand.PathToRepositoryRoot);
 						for(const auto& RelativeFile : RelativeFiles)
 						{
 							TArray<FString> OneFile;
 							OneFile.Add(RelativeFile);
-							GitSourceControlUtils::RunCommand(TEXT("lfs unlock"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), OneFile, InCommand.InfoMessages, InCommand.ErrorMessages);
+							if(GitSourceControlUtils::RunCommand(TEXT("lfs unlock"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), OneFile, InCommand.InfoMessages, InCommand.ErrorMessages))
+							{
+								LfsLockCache.OnUnlocked(RelativeFile);
+							}
 						}
 					}
 				}
@@ -256,11 +289,16 @@ bool FGitCheckInWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitCheckInWorker::UpdateStates() const
+bool FGitCheckInWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitCheckInWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 FName FGitMarkForAddWorker::GetName() const
 {
 	return "MarkForAdd";
@@ -270,7 +308,7 @@ bool FGitMarkForAddWorker::Execute(FGitSourceControlCommand& InCommand)
 {
 	check(InCommand.Operation->GetName() == GetName());
 
-	InCommand.bCommandSuccessful = GitSourceControlUtils::RunCommand(TEXT("add"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), InCommand.Files, InCommand.InfoMessages, InCommand.ErrorMessages);
+	InCommand.bCommandSuccessful = GitSourceControlUtils::RunBatchedCommand(TEXT("add"), InCommand);
 
 	// now update the status of our files
 	GitSourceControlUtils::RunUpdateStatus(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, InCommand.bUsingGitLfsLocking, InCommand.Files, InCommand.ErrorMessages, States);
@@ -278,11 +316,16 @@ bool FGitMarkForAddWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitMarkForAddWorker::UpdateStates() const
+bool FGitMarkForAddWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitMarkForAddWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 FName FGitDeleteWorker::GetName() const
 {
 	return "Delete";
@@ -292,7 +335,7 @@ bool FGitDeleteWorker::Execute(FGitSourceControlCommand& InCommand)
 {
 	check(InCommand.Operation->GetName() == GetName());
 
-	InCommand.bCommandSuccessful = GitSourceControlUtils::RunCommand(TEXT("rm"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), InCommand.Files, InCommand.InfoMessages, InCommand.ErrorMessages);
+	InCommand.bCommandSuccessful = GitSourceControlUtils::RunBatchedCommand(TEXT("rm"), InCommand);
 
 	// now update the status of our files
 	GitSourceControlUtils::RunUpdateStatus(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, InCommand.bUsingGitLfsLocking, InCommand.Files, InCommand.ErrorMessages, States);
@@ -300,11 +343,16 @@ bool FGitDeleteWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitDeleteWorker::UpdateStates() const
+bool FGitDeleteWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitDeleteWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 
 // Get lists of Missing files (ie "deleted"), Modified files, and "other than Added" Existing files
 void GetMissingVsExistingFiles(const TArray<FString>& InFiles, TArray<FString>& OutMissingFiles, TArray<FString>& OutAllExistingFiles, TArray<FString>& OutOtherThanAddedExistingFiles)
@@ -312,7 +360,27 @@ void GetMissingVsExistingFiles(const TArray<FString>& InFiles, TArray<FString>&
 	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
 	FGitSourceControlProvider& Provider = GitSourceControl.GetProvider();
 
-	const TArray<FString> Files = (InFiles.Num() > 0) ? (InFiles) : (Provider.GetFilesInCache());
+	// Without files, consider only the files of the cache that can be reverted (quicker than scanning the whole cache)
+	// and for directories, only the ones of the cache under them that can be reverted
+	TArray<FString> Files;
+	if(InFiles.Num() > 0)
+	{
+		for(const FString& File : InFiles)
+		{
+			if(FPaths::DirectoryExists(File))
+			{
+				Files.Append(Provider.GetFilesInCache(File, EGitStateIndex::Modified | EGitStateIndex::LockedByMe));
+			}
+			else
+			{
+				Files.Add(File);
+			}
+		}
+	}
+	else
+	{
+		Files = Provider.GetFilesInCache(EGitStateIndex::Modified | EGitStateIndex::LockedByMe);
+	}
 
 	TArray<TSharedRef<ISourceControlState, ESPMode::ThreadSafe>> LocalStates;
 	Provider.GetState(Files, LocalStates, EStateCacheUsage::Use);
@@ -381,12 +449,17 @@ bool FGitRevertWorker::Execute(FGitSourceControlCommand& InCommand)
 		const TArray<FString> LockedFiles = GetLockedFiles(OtherThanAddedExistingFiles);
 		if(LockedFiles.Num() > 0)
 		{
+			FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+			FGitLfsLockCache& LfsLockCache = GitSourceControl.GetProvider().GetLfsLockCache();
 			const TArray<FString> RelativeFiles = GitSourceControlUtils::RelativeFilenames(LockedFiles, InCommand.PathToRepositoryRoot);
 			for(const auto& RelativeFile : RelativeFiles)
 			{
 				TArray<FString> OneFile;
 				OneFile.Add(RelativeFile);
-				GitSourceControlUtils::RunCommand(TEXT("lfs unlock"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), OneFile, InCommand.InfoMessages, InCommand.ErrorMessages);
+				if(GitSourceControlUtils::RunCommand(TEXT("lfs unlock"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), OneFile, InCommand.InfoMessages, InCommand.ErrorMessages))
+				{
+					LfsLockCache.OnUnlocked(RelativeFile);
+				}
 			}
 		}
 	}
@@ -407,11 +480,16 @@ bool FGitRevertWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitRevertWorker::UpdateStates() const
+bool FGitRevertWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitRevertWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 FName FGitSyncWorker::GetName() const
 {
 	return "Sync";
@@ -435,11 +513,16 @@ bool FGitSyncWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitSyncWorker::UpdateStates() const
+bool FGitSyncWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitSyncWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 
 FName FGitPushWorker::GetName() const
 {
@@ -509,6 +592,7 @@ bool FGitPushWorker::Execute(FGitSourceControlCommand& InCommand)
 
 	if(InCommand.bCommandSuccessful && InCommand.bUsingGitLfsLocking && FilesToUnlock.Num() > 0)
 	{
+		FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
 		// unlock files: execute the LFS command on relative filenames
 		for(const auto& FileToUnlock : FilesToUnlock)
 		{
@@ -520,6 +604,10 @@ bool FGitPushWorker::Execute(FGitSourceControlCommand& InCommand)
 				// Report but don't fail, it's not essential
 				UE_LOG(LogSourceControl, Log, TEXT("Unlock failed for %s"), *FileToUnlock);	
 			}
+			else
+			{
+				GitSourceControl.GetProvider().GetLfsLockCache().OnUnlocked(FileToUnlock);
+			}
 		}
 		
 		// We need to update status if we unlock
@@ -532,11 +620,16 @@ bool FGitPushWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitPushWorker::UpdateStates() const
+bool FGitPushWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitPushWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 FName FGitUpdateStatusWorker::GetName() const
 {
 	return "UpdateStatus";
@@ -557,7 +650,7 @@ bool FGitUpdateStatusWorker::Execute(FGitSourceControlCommand& InCommand)
 		{
 			for(int32 Index = 0; Index < States.Num(); Index++)
 			{
-				FString& File = InCommand.Files[Index];
+				const FString& File = States[Index].LocalFilename;
 				TGitSourceControlHistory History;
 
 				if(States[Index].IsConflicted())
@@ -567,13 +660,34 @@ bool FGitUpdateStatusWorker::Execute(FGitSourceControlCommand& InCommand)
 				}
 				// Get the history of the file in the current branch
 				InCommand.bCommandSuccessful &= GitSourceControlUtils::RunGetHistory(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, File, false, InCommand.ErrorMessages, History);
-				Histories.Add(*File, History);
+				// Part of the new state of the file, so that it is applied along with it, after the check of its generation
+				States[Index].History = MoveTemp(History);
 			}
 		}
 	}
 	else
 	{
 		// no path provided: only update the status of assets in Content/ directory and also Config files
+		if(Operation->ShouldCheckAllFiles())
+		{
+			// Explicit "Refresh" of the whole repository: first update the remote-tracking branches to know about newer versions of files (throttled)
+			TArray<FString> FetchErrorMessages;
+			if(!GitSourceControlUtils::RunFetch(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, FetchErrorMessages))
+			{
+				// not a failure of the refresh itself (ie. working offline), so only report it as information
+				InCommand.InfoMessages.Append(FetchErrorMessages);
+			}
+			if(InCommand.bUsingGitLfsLocking)
+			{
+				// and the cache of the Git LFS locks
+				FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+				TArray<FString> LocksErrorMessages;
+				if(!GitSourceControl.GetProvider().GetLfsLockCache().Refresh(InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, LocksErrorMessages))
+				{
+					InCommand.InfoMessages.Append(LocksErrorMessages);
+				}
+			}
+		}
 		TArray<FString> ProjectDirs;
 		ProjectDirs.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()));
 		ProjectDirs.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectConfigDir()));
@@ -587,25 +701,14 @@ bool FGitUpdateStatusWorker::Execute(FGitSourceControlCommand& InCommand)
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitUpdateStatusWorker::UpdateStates() const
+bool FGitUpdateStatusWorker::UpdateStates()
 {
-	bool bUpdated = GitSourceControlUtils::UpdateCachedStates(States);
-
-	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>( "GitSourceControl" );
-	FGitSourceControlProvider& Provider = GitSourceControl.GetProvider();
-
-	const FDateTime Now = FDateTime::Now();
-
-	// add history, if any
-	for(const auto& History : Histories)
-	{
-		TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe> State = Provider.GetStateInternal(History.Key);
-		State->History = History.Value;
-		State->TimeStamp = Now;
-		bUpdated = true;
-	}
+	return GitSourceControlUtils::UpdateCachedStates(States);
+}
 
-	return bUpdated;
+bool FGitUpdateStatusWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
 }
 
 FName FGitCopyWorker::GetName() const
@@ -621,16 +724,21 @@ bool FGitCopyWorker::Execute(FGitSourceControlCommand& InCommand)
 	// but after a Move the Editor create a redirector file with the old asset name that points to the new asset.
 	// The redirector needs to be commited with the new asset to perform a real rename.
 	// => the following is to "MarkForAdd" the redirector, but it still need to be committed by selecting the whole directory and "check-in"
-	InCommand.bCommandSuccessful = GitSourceControlUtils::RunCommand(TEXT("add"), InCommand.PathToGitBinary, InCommand.PathToRepositoryRoot, TArray<FString>(), InCommand.Files, InCommand.InfoMessages, InCommand.ErrorMessages);
+	InCommand.bCommandSuccessful = GitSourceControlUtils::RunBatchedCommand(TEXT("add"), InCommand);
 
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitCopyWorker::UpdateStates() const
+bool FGitCopyWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitCopyWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 FName FGitResolveWorker::GetName() const
 {
 	return "Resolve";
@@ -650,9 +758,14 @@ bool FGitResolveWorker::Execute( class FGitSourceControlCommand& InCommand )
 	return InCommand.bCommandSuccessful;
 }
 
-bool FGitResolveWorker::UpdateStates() const
+bool FGitResolveWorker::UpdateStates()
 {
 	return GitSourceControlUtils::UpdateCachedStates(States);
 }
 
+bool FGitResolveWorker::HasPendingStates() const
+{
+	return States.Num() > 0;
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -32,7 +32,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -47,7 +48,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -62,7 +64,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -77,7 +80,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -92,7 +96,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -107,7 +112,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -122,7 +128,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -137,7 +144,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -152,14 +160,12 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
-	/** Temporary states for results */
+	/** Temporary states for results, along with their history if requested */
 	TArray<FGitSourceControlState> States;
-
-	/** Map of filenames to history */
-	TMap<FString, TGitSourceControlHistory> Histories;
 };
 
 /** Copy or Move operation on a single file */
@@ -170,7 +176,8 @@ public:
 	// IGitSourceControlWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 
 public:
 	/** Temporary states for results */
@@ -184,7 +191,8 @@ public:
 	virtual ~FGitResolveWorker() {}
 	virtual FName GetName() const override;
 	virtual bool Execute(class FGitSourceControlCommand& InCommand) override;
-	virtual bool UpdateStates() const override;
+	virtual bool UpdateStates() override;
+	virtual bool HasPendingStates() const override;
 	
 private:
 	/** Temporary states for results */
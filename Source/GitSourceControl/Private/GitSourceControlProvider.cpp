@@ -6,9 +6,13 @@
 #include "GitSourceControlProvider.h"
 
 #include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
-#include "Misc/QueuedThreadPool.h"
+#include "Misc/ScopeLock.h"
 #include "Modules/ModuleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "GitSourceControlCommand.h"
 #include "ISourceControlModule.h"
@@ -25,6 +29,68 @@
 
 static FName ProviderName("Git LFS 2");
 
+/** Maximum number of asynchronous UpdateStatus commands running at once, the next ones being deferred and merged (see IssueUpdateStatusCommand()) */
+static const int32 MaxRunningUpdateStatusCommands = 2;
+
+/** Tells if a command is an asynchronous UpdateStatus, that can be deferred and merged */
+static bool IsDeferrableUpdateStatus(const FGitSourceControlCommand& InCommand)
+{
+	return InCommand.bAutoDelete && (InCommand.Operation->GetName() == "UpdateStatus");
+}
+
+/** Tells if two UpdateStatus commands can run as one: same options, and overlapping files (or both for the whole project) */
+static bool CanMergeUpdateStatus(const FGitSourceControlCommand& InCommand, const FGitSourceControlCommand& InOther)
+{
+	const TSharedRef<FUpdateStatus, ESPMode::ThreadSafe> Operation = StaticCastSharedRef<FUpdateStatus>(InCommand.Operation);
+	const TSharedRef<FUpdateStatus, ESPMode::ThreadSafe> OtherOperation = StaticCastSharedRef<FUpdateStatus>(InOther.Operation);
+	if ((Operation->ShouldUpdateHistory() != OtherOperation->ShouldUpdateHistory()) || (Operation->ShouldCheckAllFiles() != OtherOperation->ShouldCheckAllFiles()))
+	{
+		return false;
+	}
+	if ((InCommand.Files.Num() == 0) || (InOther.Files.Num() == 0))
+	{
+		return (InCommand.Files.Num() == 0) && (InOther.Files.Num() == 0);
+	}
+	const TSet<FString> Files(InCommand.Files);
+	for (const FString& File : InOther.Files)
+	{
+		if (Files.Contains(File))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Time during which the consecutive asynchronous write operations of the same kind are gathered into one command, in seconds (see IssueBatchedCommand()) */
+static const double WriteBatchWindow = 0.1;
+
+/** Tells if a command is an asynchronous write operation that can be batched with the next ones of the same kind */
+static bool IsBatchableWrite(const FGitSourceControlCommand& InCommand)
+{
+	const FName OperationName = InCommand.Operation->GetName();
+	return InCommand.bAutoDelete && ((OperationName == "MarkForAdd") || (OperationName == "Delete") || (OperationName == "Copy"));
+}
+
+/** Time during which the remote is considered offline after a Git command contacting it timed out, in seconds (see MarkRemoteOffline()) */
+static const double RemoteOfflineDuration = 60.0;
+
+/** Maximum time to wait for a synchronous command to be processed before ticking its progress dialog again, in milliseconds */
+static const uint32 SynchronousCommandWaitTime = 50;
+
+namespace GitSourceControlSnapshot
+{
+	/** Identifies a state snapshot file, and its format */
+	const uint32 Magic = 0x53535447; // "GTSS"
+	const uint32 Version = 1;
+
+	/** The state snapshot is saved with the other files of the project that are not under source control */
+	static FString GetFilename()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("GitSourceControl") / TEXT("StateSnapshot.bin");
+	}
+}
+
 void FGitSourceControlProvider::Init(bool bForceConnection)
 {
 	// Init() is called multiple times at startup: do not check git each time
@@ -91,6 +157,9 @@ void FGitSourceControlProvider::CheckRepositoryStatus(const FString& InPathToGit
 		if (bGitRepositoryFound)
 		{
 			GitSourceControlUtils::GetRemoteUrl(InPathToGitBinary, PathToRepositoryRoot, RemoteUrl);
+
+			// Show the states of the previous session right away, while the Connect operation reconciles them
+			LoadStateSnapshot();
 		}
 		else
 		{
@@ -108,8 +177,87 @@ void FGitSourceControlProvider::CheckRepositoryStatus(const FString& InPathToGit
 
 void FGitSourceControlProvider::Close()
 {
-	// clear the cache
+	// save the cache for the next session, then clear it
+	SaveStateSnapshot();
 	StateCache.Empty();
+	{
+		FScopeLock ScopeLock(&StateSnapshotCriticalSection);
+		StateSnapshotFiles.Reset();
+		bStateSnapshotLoaded = false;
+	}
+	{
+		FScopeLock ScopeLock(&ChangedFilesCriticalSection);
+		ChangedFiles.Reset();
+	}
+	// Cancel the batched and deferred commands
+	if (BatchedCommand)
+	{
+		BatchedCommand->ReturnResults();
+		delete BatchedCommand;
+		BatchedCommand = nullptr;
+	}
+	for (FGitSourceControlCommand* Command : DeferredUpdateStatusCommands)
+	{
+		Command->ReturnResults();
+		delete Command;
+	}
+	DeferredUpdateStatusCommands.Reset();
+	// Cancel the running read-only commands so as not to wait for their Git processes, abandon the queued ones, and stop the worker threads.
+	// The running writes are waited for: terminating Git in the middle of a write could leave the repository with a stale "index.lock",
+	// or with only some of the files of the operation changed (ie. committed, but not pushed).
+	for (FGitSourceControlCommand* Command : CommandQueue)
+	{
+		if (!IsWriteCommand(*Command))
+		{
+			Command->Cancel();
+		}
+	}
+	Scheduler.RequestStop();
+	if (Scheduler.GetStats().NumRunning > 0)
+	{
+		// Do not freeze the editor without a word until a long write (ie. a push) finishes, or times out (see FGitSourceControlSettings):
+		// show the progress, with a Cancel button terminating the Git processes as a last resort
+		UE_LOG(LogSourceControl, Log, TEXT("Close: waiting for %d running commands"), Scheduler.GetStats().NumRunning);
+		FScopedSourceControlProgress Progress(LOCTEXT("WaitingForWrites", "Waiting for the Git commands writing to the repository..."), FSimpleDelegate::CreateLambda([this]()
+		{
+			UE_LOG(LogSourceControl, Warning, TEXT("Close: cancelling the commands writing to the repository"));
+			for (FGitSourceControlCommand* Command : CommandQueue)
+			{
+				Command->Cancel();
+			}
+		}));
+		while (Scheduler.GetStats().NumRunning > 0)
+		{
+			Progress.Tick();
+			FPlatformProcess::Sleep(SynchronousCommandWaitTime / 1000.0f);
+		}
+	}
+	Scheduler.Stop();
+	FGitSourceControlCommand* CompletedCommand = nullptr;
+	while (CompletedCommands.Dequeue(CompletedCommand))
+	{
+		ReadyCommands.Add(CompletedCommand);
+	}
+	for (FGitSourceControlCommand* Command : ReadyCommands)
+	{
+		CommandQueue.Remove(Command);
+		Command->ReturnResults();
+		if (Command->bAutoDelete)
+		{
+			delete Command;
+		}
+	}
+	ReadyCommands.Reset();
+	NumRunningUpdateStatusCommands = 0;
+	{
+		FScopeLock ScopeLock(&RemoteOfflineCriticalSection);
+		RemoteOfflineUntil = 0.0;
+	}
+	// Stop the long-lived Git processes
+	CatFileBatch.Stop();
+	CatFileBatchCheck.Stop();
+	LfsLockCache.Stop();
+	RepositoryReader.Reset();
 	// Remove all extensions to the "Source Control" menu in the Editor Toolbar
 	GitSourceControlMenu.Unregister();
 	// Unregister Console Commands
@@ -121,21 +269,251 @@ void FGitSourceControlProvider::Close()
 	UserEmail.Empty();
 }
 
-TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe> FGitSourceControlProvider::GetStateInternal(const FString& Filename)
+/**
+ * The state snapshot is a binary file:
+ * - header: magic, version, repository root, commit id and index checksum (the key of the snapshot)
+ * - number of states, then for each: filename (relative to the repository root), working copy state, lock state, lock user, newer version on server
+ */
+void FGitSourceControlProvider::SaveStateSnapshot()
 {
-	TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe>* State = StateCache.Find(Filename);
-	if (State != NULL)
+	FString SnapshotCommitId;
+	FString IndexChecksum;
+	if(!bGitRepositoryFound || (StateCache.Num() == 0) || !RepositoryReader.GetCommitId(PathToRepositoryRoot, SnapshotCommitId) || !RepositoryReader.GetIndexChecksum(PathToRepositoryRoot, IndexChecksum))
+	{
+		return;
+	}
+
+	FString RootWithSlash = PathToRepositoryRoot;
+	if(!RootWithSlash.EndsWith(TEXT("/")))
+	{
+		RootWithSlash += TEXT("/");
+	}
+	TArray<FGitSourceControlStateRef> States = StateCache.GetStates();
+	States.RemoveAll([&RootWithSlash](const FGitSourceControlStateRef& InState)
+	{
+		return (InState->WorkingCopyState == EWorkingCopyState::Unknown) || !InState->LocalFilename.StartsWith(RootWithSlash);
+	});
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	uint32 Magic = GitSourceControlSnapshot::Magic;
+	uint32 Version = GitSourceControlSnapshot::Version;
+	FString RepositoryRoot = PathToRepositoryRoot;
+	int32 NumStates = States.Num();
+	Writer << Magic << Version << RepositoryRoot << SnapshotCommitId << IndexChecksum << NumStates;
+	for(const FGitSourceControlStateRef& State : States)
+	{
+		FString Filename = State->LocalFilename.RightChop(RootWithSlash.Len());
+		uint8 WorkingCopyState = State->WorkingCopyState.GetValue();
+		uint8 LockState = State->LockState.GetValue();
+		FString LockUser = State->LockUser.IsNone() ? FString() : State->LockUser.ToString();
+		bool bNewerVersionOnServer = State->bNewerVersionOnServer;
+		Writer << Filename << WorkingCopyState << LockState << LockUser << bNewerVersionOnServer;
+	}
+
+	const FString Filename = GitSourceControlSnapshot::GetFilename();
+	if(FFileHelper::SaveArrayToFile(Data, *Filename))
 	{
-		// found cached item
-		return (*State);
+		UE_LOG(LogSourceControl, Log, TEXT("Saved %d states to '%s'"), NumStates, *Filename);
 	}
 	else
 	{
-		// cache an unknown state for this item
-		TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe> NewState = MakeShareable(new FGitSourceControlState(Filename, bUsingGitLfsLocking));
-		StateCache.Add(Filename, NewState);
-		return NewState;
+		UE_LOG(LogSourceControl, Warning, TEXT("Failed to save the states to '%s'"), *Filename);
+	}
+}
+
+void FGitSourceControlProvider::LoadStateSnapshot()
+{
+	const FString Filename = GitSourceControlSnapshot::GetFilename();
+	TArray<uint8> Data;
+	if(!FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent))
+	{
+		return;
+	}
+
+	FString CurrentCommitId;
+	FString CurrentIndexChecksum;
+	if(!RepositoryReader.GetCommitId(PathToRepositoryRoot, CurrentCommitId) || !RepositoryReader.GetIndexChecksum(PathToRepositoryRoot, CurrentIndexChecksum))
+	{
+		return;
+	}
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	FString RepositoryRoot;
+	FString SnapshotCommitId;
+	FString IndexChecksum;
+	int32 NumStates = 0;
+	Reader << Magic << Version;
+	if((Magic != GitSourceControlSnapshot::Magic) || (Version != GitSourceControlSnapshot::Version))
+	{
+		return;
+	}
+	Reader << RepositoryRoot << SnapshotCommitId << IndexChecksum << NumStates;
+	if(Reader.IsError() || (RepositoryRoot != PathToRepositoryRoot) || (SnapshotCommitId != CurrentCommitId) || (IndexChecksum != CurrentIndexChecksum) || (NumStates < 0))
+	{
+		UE_LOG(LogSourceControl, Log, TEXT("Ignoring the states of '%s': the repository changed since"), *Filename);
+		return;
+	}
+
+	const FDateTime Now = FDateTime::Now();
+	TArray<FGitSourceControlStateRef> States;
+	TArray<FString> FilesToReconcile;
+	States.Reserve(NumStates);
+	for(int32 Index = 0; Index < NumStates; ++Index)
+	{
+		FString RelativeFilename;
+		uint8 WorkingCopyState = 0;
+		uint8 LockState = 0;
+		FString LockUser;
+		bool bNewerVersionOnServer = false;
+		Reader << RelativeFilename << WorkingCopyState << LockState << LockUser << bNewerVersionOnServer;
+		if(Reader.IsError() || (WorkingCopyState > EWorkingCopyState::Ignored) || (LockState > ELockState::LockedOther))
+		{
+			UE_LOG(LogSourceControl, Warning, TEXT("Failed to load the states from '%s'"), *Filename);
+			return;
+		}
+
+		FGitSourceControlStateRef State = MakeShared<FGitSourceControlState, ESPMode::ThreadSafe>(FPaths::ConvertRelativePathToFull(PathToRepositoryRoot, RelativeFilename), bUsingGitLfsLocking);
+		State->WorkingCopyState = static_cast<EWorkingCopyState::Type>(WorkingCopyState);
+		State->LockState = static_cast<ELockState::Type>(LockState);
+		State->LockUser = FName(*LockUser);
+		State->bNewerVersionOnServer = bNewerVersionOnServer;
+		State->TimeStamp = Now;
+		if((State->WorkingCopyState != EWorkingCopyState::Unchanged) || (State->LockState == ELockState::Locked) || (State->LockState == ELockState::LockedOther) || State->bNewerVersionOnServer)
+		{
+			FilesToReconcile.Add(State->LocalFilename);
+		}
+		States.Add(MoveTemp(State));
+	}
+
+	TArray<FString> LoadedFiles;
+	LoadedFiles.Reserve(States.Num());
+	for(const FGitSourceControlStateRef& State : States)
+	{
+		StateCache.Add(State);
+		LoadedFiles.Add(State->LocalFilename);
+	}
+	AddChangedFiles(LoadedFiles);
+	{
+		FScopeLock ScopeLock(&StateSnapshotCriticalSection);
+		StateSnapshotFiles = MoveTemp(FilesToReconcile);
+		bStateSnapshotLoaded = true;
+	}
+	UE_LOG(LogSourceControl, Log, TEXT("Loaded %d states from '%s'"), NumStates, *Filename);
+}
+
+bool FGitSourceControlProvider::ConsumeStateSnapshot(TArray<FString>& OutFiles)
+{
+	FScopeLock ScopeLock(&StateSnapshotCriticalSection);
+	if(!bStateSnapshotLoaded)
+	{
+		return false;
+	}
+	OutFiles = MoveTemp(StateSnapshotFiles);
+	StateSnapshotFiles.Reset();
+	bStateSnapshotLoaded = false;
+	return true;
+}
+
+TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe> FGitSourceControlProvider::GetStateInternal(const FString& Filename)
+{
+	// find the cached item, or cache an unknown state for this item
+	return StateCache.FindOrAdd(Filename, bUsingGitLfsLocking);
+}
+
+void FGitSourceControlProvider::UpdateStateInternal(FGitSourceControlState&& InState, const FDateTime& InTimeStamp)
+{
+	const FString Filename = InState.LocalFilename;
+	InState.Generation = ApplyingGeneration;
+	if(StateCache.Update(MoveTemp(InState), InTimeStamp))
+	{
+		AddChangedFiles({ Filename });
+	}
+}
+
+void FGitSourceControlProvider::AddChangedFiles(const TArray<FString>& InFilenames)
+{
+	FScopeLock ScopeLock(&ChangedFilesCriticalSection);
+	ChangedFiles.Append(InFilenames);
+}
+
+void FGitSourceControlProvider::BroadcastChangedFiles()
+{
+	TArray<FString> Filenames;
+	{
+		FScopeLock ScopeLock(&ChangedFilesCriticalSection);
+		Filenames = ChangedFiles.Array();
+		ChangedFiles.Reset();
+	}
+	if(Filenames.Num() > 0)
+	{
+		OnFilesChanged.Broadcast(Filenames);
+		OnSourceControlStateChanged.Broadcast();
+	}
+}
+
+void FGitSourceControlProvider::UpdateChangedLocks()
+{
+	TMap<FString, FString> ChangedLocks;
+	LfsLockCache.TakeChangedLocks(ChangedLocks);
+	if (!bUsingGitLfsLocking || (ChangedLocks.Num() == 0))
+	{
+		return;
+	}
+
+	const FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	const FString LfsUserName = GitSourceControl.AccessSettings().GetLfsUserName();
+	const FDateTime Now = FDateTime::Now();
+	for (const auto& ChangedLock : ChangedLocks)
+	{
+		// only the files already in the cache: the others get their lock along with their status
+		const FGitSourceControlStatePtr CachedState = StateCache.Find(FPaths::ConvertRelativePathToFull(PathToRepositoryRoot, ChangedLock.Key));
+		if (!CachedState.IsValid())
+		{
+			continue;
+		}
+		// a copy of the cached state, keeping its generation, replacing it as a whole
+		FGitSourceControlState State(*CachedState);
+		if (ChangedLock.Value.IsEmpty())
+		{
+			State.LockState = ELockState::NotLocked;
+			State.LockUser = NAME_None;
+		}
+		else
+		{
+			State.LockState = (ChangedLock.Value == LfsUserName) ? ELockState::Locked : ELockState::LockedOther;
+			State.LockUser = FName(*ChangedLock.Value);
+		}
+		const FString Filename = State.LocalFilename;
+		if (StateCache.Update(MoveTemp(State), Now))
+		{
+			AddChangedFiles({ Filename });
+		}
+	}
+}
+
+FDelegateHandle FGitSourceControlProvider::RegisterFilesChanged_Handle(const FGitSourceControlFilesChanged::FDelegate& InFilesChanged)
+{
+	return OnFilesChanged.Add(InFilesChanged);
+}
+
+void FGitSourceControlProvider::UnregisterFilesChanged_Handle(FDelegateHandle InHandle)
+{
+	OnFilesChanged.Remove(InHandle);
+}
+
+bool FGitSourceControlProvider::TryStartFetch(const double InMinInterval)
+{
+	FScopeLock ScopeLock(&LastFetchCriticalSection);
+	const double Now = FPlatformTime::Seconds();
+	if((LastFetchTime > 0.0) && (Now - LastFetchTime < InMinInterval))
+	{
+		return false;
 	}
+	LastFetchTime = Now;
+	return true;
 }
 
 FText FGitSourceControlProvider::GetStatusText() const
@@ -218,9 +596,9 @@ ECommandResult::Type FGitSourceControlProvider::GetState(const TArray<FSourceCon
 TArray<FSourceControlStateRef> FGitSourceControlProvider::GetCachedStateByPredicate(TFunctionRef<bool(const FSourceControlStateRef&)> Predicate) const
 {
 	TArray<FSourceControlStateRef> Result;
-	for (const auto& CacheItem : StateCache)
+	for (const FGitSourceControlStateRef& CacheItem : StateCache.GetStates())
 	{
-		FSourceControlStateRef State = CacheItem.Value;
+		FSourceControlStateRef State = CacheItem;
 		if (Predicate(State))
 		{
 			Result.Add(State);
@@ -231,18 +609,43 @@ TArray<FSourceControlStateRef> FGitSourceControlProvider::GetCachedStateByPredic
 
 bool FGitSourceControlProvider::RemoveFileFromCache(const FString& Filename)
 {
-	return StateCache.Remove(Filename) > 0;
+	if(StateCache.Remove(Filename))
+	{
+		AddChangedFiles({ Filename });
+		return true;
+	}
+	return false;
 }
 
 /** Get files in cache */
 TArray<FString> FGitSourceControlProvider::GetFilesInCache()
 {
-	TArray<FString> Files;
-	for (const auto& State : StateCache)
+	return StateCache.GetFilenames();
+}
+
+TArray<FString> FGitSourceControlProvider::GetFilesInCache(const uint32 InIndices) const
+{
+	return StateCache.GetFilenames(InIndices);
+}
+
+TArray<FSourceControlStateRef> FGitSourceControlProvider::GetCachedStatesByIndex(const uint32 InIndices) const
+{
+	TArray<FSourceControlStateRef> Result;
+	for (const FGitSourceControlStateRef& State : StateCache.GetStates(InIndices))
 	{
-		Files.Add(State.Key);
+		Result.Add(State);
 	}
-	return Files;
+	return Result;
+}
+
+TArray<FString> FGitSourceControlProvider::GetFilesInCache(const FString& InDirectory, const uint32 InIndices) const
+{
+	return StateCache.GetFilenamesInDirectory(InDirectory, InIndices);
+}
+
+FGitDirectoryStateCounts FGitSourceControlProvider::GetDirectoryStateCounts(const FString& InDirectory) const
+{
+	return StateCache.GetDirectoryStateCounts(InDirectory);
 }
 
 FDelegateHandle FGitSourceControlProvider::RegisterSourceControlStateChanged_Handle(const FSourceControlStateChanged::FDelegate& SourceControlStateChanged)
@@ -294,6 +697,9 @@ ECommandResult::Type FGitSourceControlProvider::Execute(const TSharedRef<ISource
 	{
 		Command->bAutoDelete = false;
 
+		// keep the order of the operations: the batched ones were issued before this one
+		FlushBatchedCommand(true);
+
 		UE_LOG(LogSourceControl, Log, TEXT("ExecuteSynchronousCommand(%s)"), *InOperation->GetName().ToString());
 		return ExecuteSynchronousCommand(*Command, InOperation->GetInProgressString());
 	}
@@ -302,6 +708,15 @@ ECommandResult::Type FGitSourceControlProvider::Execute(const TSharedRef<ISource
 		Command->bAutoDelete = true;
 
 		UE_LOG(LogSourceControl, Log, TEXT("IssueAsynchronousCommand(%s)"), *InOperation->GetName().ToString());
+		if (IsBatchableWrite(*Command))
+		{
+			return IssueBatchedCommand(*Command);
+		}
+		FlushBatchedCommand(true);
+		if (IsDeferrableUpdateStatus(*Command))
+		{
+			return IssueUpdateStatusCommand(*Command);
+		}
 		return IssueCommand(*Command);
 	}
 }
@@ -313,11 +728,64 @@ bool FGitSourceControlProvider::CanExecuteOperation( const FSourceControlOperati
 
 bool FGitSourceControlProvider::CanCancelOperation(const FSourceControlOperationRef& InOperation) const
 {
-	return false;
+	const FGitSourceControlCommand* Command = FindCommand(InOperation);
+	return (Command != nullptr) && !Command->bExecuteProcessed && !Command->IsCancelled();
 }
 
 void FGitSourceControlProvider::CancelOperation(const FSourceControlOperationRef& InOperation)
 {
+	if (FGitSourceControlCommand* Command = FindCommand(InOperation))
+	{
+		if (Command->GetNumOperations() > 1)
+		{
+			// An operation batched or merged with others completes right away, the command keeping running for the others
+			UE_LOG(LogSourceControl, Log, TEXT("Cancelling %s, detached from %d other operations"), *InOperation->GetName().ToString(), Command->GetNumOperations() - 1);
+			Command->DetachOperation(InOperation, CommandQueue.Contains(Command));
+		}
+		else
+		{
+			// A command not started yet fails as soon as a worker thread picks it up, a running one as soon as its Git process is terminated
+			UE_LOG(LogSourceControl, Log, TEXT("Cancelling %s"), *InOperation->GetName().ToString());
+			Command->Cancel();
+		}
+	}
+}
+
+void FGitSourceControlProvider::MarkRemoteOffline()
+{
+	FScopeLock ScopeLock(&RemoteOfflineCriticalSection);
+	RemoteOfflineUntil = FPlatformTime::Seconds() + RemoteOfflineDuration;
+	UE_LOG(LogSourceControl, Warning, TEXT("Remote considered offline for %.0f seconds"), RemoteOfflineDuration);
+}
+
+bool FGitSourceControlProvider::IsRemoteOffline(double& OutRemainingTime) const
+{
+	FScopeLock ScopeLock(&RemoteOfflineCriticalSection);
+	OutRemainingTime = RemoteOfflineUntil - FPlatformTime::Seconds();
+	return OutRemainingTime > 0.0;
+}
+
+FGitSourceControlCommand* FGitSourceControlProvider::FindCommand(const FSourceControlOperationRef& InOperation) const
+{
+	for (FGitSourceControlCommand* Command : CommandQueue)
+	{
+		if (Command->HasOperation(InOperation))
+		{
+			return Command;
+		}
+	}
+	for (FGitSourceControlCommand* Command : DeferredUpdateStatusCommands)
+	{
+		if (Command->HasOperation(InOperation))
+		{
+			return Command;
+		}
+	}
+	if ((BatchedCommand != nullptr) && BatchedCommand->HasOperation(InOperation))
+	{
+		return BatchedCommand;
+	}
+	return nullptr;
 }
 
 bool FGitSourceControlProvider::UsesLocalReadOnlyState() const
@@ -405,6 +873,19 @@ void FGitSourceControlProvider::OutputCommandMessages(const FGitSourceControlCom
 	{
 		SourceControlLog.Info(FText::FromString(InCommand.InfoMessages[InfoIndex]));
 	}
+
+	// and the own messages of the batched operations, if the command failed and was run again for each one (see RunBatchedCommand())
+	for (const FGitMergedOperation& MergedOperation : InCommand.MergedOperations)
+	{
+		for (const FString& ErrorMessage : MergedOperation.ErrorMessages)
+		{
+			SourceControlLog.Error(FText::FromString(ErrorMessage));
+		}
+		for (const FString& InfoMessage : MergedOperation.InfoMessages)
+		{
+			SourceControlLog.Info(FText::FromString(InfoMessage));
+		}
+	}
 }
 
 void FGitSourceControlProvider::UpdateRepositoryStatus(const class FGitSourceControlCommand& InCommand)
@@ -419,45 +900,65 @@ void FGitSourceControlProvider::UpdateRepositoryStatus(const class FGitSourceCon
 
 void FGitSourceControlProvider::Tick()
 {
-	bool bStatesUpdated = false;
+	// issue the batches of write operations gathered long enough
+	FlushBatchedCommand(false);
 
-	for (int32 CommandIndex = 0; CommandIndex < CommandQueue.Num(); ++CommandIndex)
+	// show the locks of others as soon as known, without waiting for the next status of their files
+	UpdateChangedLocks();
+
+	// take the commands completed by the worker threads since the last tick, in their order of completion
+	FGitSourceControlCommand* CompletedCommand = nullptr;
+	while (CompletedCommands.Dequeue(CompletedCommand))
 	{
-		FGitSourceControlCommand& Command = *CommandQueue[CommandIndex];
-		if (Command.bExecuteProcessed)
+		ReadyCommands.Add(CompletedCommand);
+	}
+
+	// finalize all of them; the first one is re-read on each iteration, since a completion delegate can run a synchronous command,
+	// thus a nested Tick() finalizing some of the commands, or issue new ones
+	while (ReadyCommands.Num() > 0)
+	{
+		FGitSourceControlCommand& Command = *ReadyCommands[0];
+
+		// let command update the states of any files (the ones that actually changed are notified below)
+		ApplyingGeneration = Command.Generation;
+		Command.Worker->UpdateStates();
+		ApplyingGeneration = 0;
+		if (Command.Worker->HasPendingStates())
 		{
-			// Remove command from the queue
-			CommandQueue.RemoveAt(CommandIndex);
+			// large results are applied over a few ticks, before completing the command (and the next ones, to keep them in order)
+			break;
+		}
 
-			// Update respository status on UpdateStatus operations
-			UpdateRepositoryStatus(Command);
+		// Remove command from the queues
+		ReadyCommands.RemoveAt(0);
+		CommandQueue.Remove(&Command);
 
-			// let command update the states of any files
-			bStatesUpdated |= Command.Worker->UpdateStates();
+		// and let a deferred UpdateStatus take its place
+		if (IsDeferrableUpdateStatus(Command))
+		{
+			--NumRunningUpdateStatusCommands;
+			IssueDeferredUpdateStatusCommands();
+		}
 
-			// dump any messages to output log
-			OutputCommandMessages(Command);
+		// Update respository status on UpdateStatus operations
+		UpdateRepositoryStatus(Command);
 
-			// run the completion delegate callback if we have one bound
-			Command.ReturnResults();
+		// dump any messages to output log
+		OutputCommandMessages(Command);
 
-			// commands that are left in the array during a tick need to be deleted
-			if (Command.bAutoDelete)
-			{
-				// Only delete commands that are not running 'synchronously'
-				delete &Command;
-			}
+		// run the completion delegate callback if we have one bound
+		Command.ReturnResults();
 
-			// only do one command per tick loop, as we dont want concurrent modification
-			// of the command queue (which can happen in the completion delegate)
-			break;
+		// commands that are left in the array during a tick need to be deleted
+		if (Command.bAutoDelete)
+		{
+			// Only delete commands that are not running 'synchronously'
+			delete &Command;
 		}
 	}
 
-	if (bStatesUpdated)
-	{
-		OnSourceControlStateChanged.Broadcast();
-	}
+	// notify all the changes of this tick at once, if any
+	BroadcastChangedFiles();
 }
 
 TArray<TSharedRef<ISourceControlLabel>> FGitSourceControlProvider::GetLabels(const FString& InMatchingSpec) const
@@ -490,9 +991,14 @@ ECommandResult::Type FGitSourceControlProvider::ExecuteSynchronousCommand(FGitSo
 
 	// Display the progress dialog if a string was provided
 	{
-		FScopedSourceControlProgress Progress(Task);
+		// with a Cancel button terminating the Git process of the command
+		FScopedSourceControlProgress Progress(Task, FSimpleDelegate::CreateLambda([&InCommand]()
+		{
+			InCommand.Cancel();
+		}));
 
 		// Issue the command asynchronously...
+		InCommand.ProcessedEvent = FPlatformProcess::GetSynchEventFromPool(true);
 		IssueCommand(InCommand);
 
 		// ... then wait for its completion (thus making it synchronous)
@@ -503,12 +1009,17 @@ ECommandResult::Type FGitSourceControlProvider::ExecuteSynchronousCommand(FGitSo
 
 			Progress.Tick();
 
-			// Sleep for a bit so we don't busy-wait so much.
-			FPlatformProcess::Sleep(0.01f);
+			// Wait for the command to be processed, waking up regularly only to keep the progress dialog responsive
+			InCommand.ProcessedEvent->Wait(SynchronousCommandWaitTime);
 		}
 
-		// always do one more Tick() to make sure the command queue is cleaned up.
-		Tick();
+		// always do one more Tick() to make sure the command queue is cleaned up,
+		// and more if its results are applied over a few ticks (see UpdateCachedStates())
+		do
+		{
+			Tick();
+		}
+		while (CommandQueue.Contains(&InCommand));
 
 		if (InCommand.bCommandSuccessful)
 		{
@@ -519,6 +1030,9 @@ ECommandResult::Type FGitSourceControlProvider::ExecuteSynchronousCommand(FGitSo
 	// Delete the command now (asynchronous commands are deleted in the Tick() method)
 	check(!InCommand.bAutoDelete);
 
+	FPlatformProcess::ReturnSynchEventToPool(InCommand.ProcessedEvent);
+	InCommand.ProcessedEvent = nullptr;
+
 	// ensure commands that are not auto deleted do not end up in the command queue
 	if (CommandQueue.Contains(&InCommand))
 	{
@@ -529,25 +1043,107 @@ ECommandResult::Type FGitSourceControlProvider::ExecuteSynchronousCommand(FGitSo
 	return Result;
 }
 
-ECommandResult::Type FGitSourceControlProvider::IssueCommand(FGitSourceControlCommand& InCommand)
+ECommandResult::Type FGitSourceControlProvider::IssueBatchedCommand(FGitSourceControlCommand& InCommand)
 {
-	if (GThreadPool != nullptr)
+	if (BatchedCommand && !BatchedCommand->IsCancelled() && (BatchedCommand->Operation->GetName() == InCommand.Operation->GetName()))
 	{
-		// Queue this to our worker thread(s) for resolving
-		GThreadPool->AddQueuedWork(&InCommand);
-		CommandQueue.Add(&InCommand);
+		BatchedCommand->Merge(InCommand);
+		delete &InCommand;
 		return ECommandResult::Succeeded;
 	}
-	else
+
+	// keep the order of the operations: the batch of another kind was issued before this one
+	FlushBatchedCommand(true);
+	BatchedCommand = &InCommand;
+	BatchStartTime = FPlatformTime::Seconds();
+	return ECommandResult::Succeeded;
+}
+
+void FGitSourceControlProvider::FlushBatchedCommand(const bool bInForce)
+{
+	if (BatchedCommand && (bInForce || (FPlatformTime::Seconds() - BatchStartTime >= WriteBatchWindow)))
 	{
-		FText Message(LOCTEXT("NoSCCThreads", "There are no threads available to process the source control command."));
+		UE_LOG(LogSourceControl, Log, TEXT("IssueBatchedCommand(%s) for %d operations, %d files"), *BatchedCommand->Operation->GetName().ToString(), BatchedCommand->MergedOperations.Num() + 1, BatchedCommand->Files.Num());
+		FGitSourceControlCommand* Command = BatchedCommand;
+		BatchedCommand = nullptr;
+		IssueCommand(*Command);
+	}
+}
 
-		FMessageLog("SourceControl").Error(Message);
-		InCommand.bCommandSuccessful = false;
-		InCommand.Operation->AddErrorMessge(Message);
+ECommandResult::Type FGitSourceControlProvider::IssueUpdateStatusCommand(FGitSourceControlCommand& InCommand)
+{
+	for (FGitSourceControlCommand* DeferredCommand : DeferredUpdateStatusCommands)
+	{
+		if (!DeferredCommand->IsCancelled() && CanMergeUpdateStatus(*DeferredCommand, InCommand))
+		{
+			UE_LOG(LogSourceControl, Verbose, TEXT("UpdateStatus of %d files merged into a deferred one"), InCommand.Files.Num());
+			DeferredCommand->Merge(InCommand);
+			delete &InCommand;
+			return ECommandResult::Succeeded;
+		}
+	}
+
+	DeferredUpdateStatusCommands.Add(&InCommand);
+	IssueDeferredUpdateStatusCommands();
+	return ECommandResult::Succeeded;
+}
+
+void FGitSourceControlProvider::IssueDeferredUpdateStatusCommands()
+{
+	while ((DeferredUpdateStatusCommands.Num() > 0) && (NumRunningUpdateStatusCommands < MaxRunningUpdateStatusCommands))
+	{
+		FGitSourceControlCommand* Command = DeferredUpdateStatusCommands[0];
+		DeferredUpdateStatusCommands.RemoveAt(0);
+		++NumRunningUpdateStatusCommands;
+		IssueCommand(*Command);
+	}
+}
+
+EGitCommandPriority::Type FGitSourceControlProvider::GetCommandPriority(const FGitSourceControlCommand& InCommand)
+{
+	// the user is waiting for synchronous commands
+	if (!InCommand.bAutoDelete)
+	{
+		return EGitCommandPriority::Interactive;
+	}
+	const FName OperationName = InCommand.Operation->GetName();
+	if (OperationName == "UpdateStatus")
+	{
+		return EGitCommandPriority::Background;
+	}
+	if ((OperationName == "CheckIn") || (OperationName == "Sync") || (OperationName == "Push") || (OperationName == "Connect"))
+	{
+		return EGitCommandPriority::Bulk;
+	}
+	return EGitCommandPriority::Interactive;
+}
 
-		return InCommand.ReturnResults();
+bool FGitSourceControlProvider::IsWriteCommand(const FGitSourceControlCommand& InCommand) const
+{
+	if (!GitVersion.bHasNoOptionalLocks)
+	{
+		return true;
 	}
+
+	// only the status commands leave the repository as is
+	const FName OperationName = InCommand.Operation->GetName();
+	return (OperationName != "UpdateStatus") && (OperationName != "Connect");
+}
+
+ECommandResult::Type FGitSourceControlProvider::IssueCommand(FGitSourceControlCommand& InCommand)
+{
+	if (!Scheduler.IsStarted())
+	{
+		const FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+		Scheduler.Start(GitSourceControl.AccessSettings().GetNumWorkerThreads());
+	}
+
+	// Queue this to our worker thread(s) for resolving, to be handed back through the completed queue
+	InCommand.Generation = ++LastCommandGeneration;
+	InCommand.CompletedQueue = &CompletedCommands;
+	CommandQueue.Add(&InCommand);
+	Scheduler.AddQueuedWork(&InCommand, GetCommandPriority(InCommand), FGitCommandScope(InCommand.Files, IsWriteCommand(InCommand)));
+	return ECommandResult::Succeeded;
 }
 
 #undef LOCTEXT_NAMESPACE
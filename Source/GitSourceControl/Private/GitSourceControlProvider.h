@@ -10,16 +10,23 @@
 #include "ISourceControlState.h"
 #include "ISourceControlProvider.h"
 #include "IGitSourceControlWorker.h"
+#include "GitSourceControlCommand.h"
 #include "GitSourceControlState.h"
+#include "GitSourceControlStateCache.h"
+#include "GitSourceControlCatFile.h"
+#include "GitSourceControlLfsLocks.h"
+#include "GitSourceControlRepository.h"
+#include "GitSourceControlScheduler.h"
 #include "GitSourceControlMenu.h"
 #include "GitSourceControlConsole.h"
 
 #include "Runtime/Launch/Resources/Version.h"
 
-class FGitSourceControlCommand;
-
 DECLARE_DELEGATE_RetVal(FGitSourceControlWorkerRef, FGetGitSourceControlWorker)
 
+/** Delegate called at most once per tick with the files whose displayed state changed since the previous call */
+DECLARE_MULTICAST_DELEGATE_OneParam(FGitSourceControlFilesChanged, const TArray<FString>& /* InFilenames */);
+
 /// Git version and capabilites extracted from the string "git version 2.11.0.windows.3"
 struct FGitVersion
 {
@@ -30,6 +37,8 @@ struct FGitVersion
 	int Windows; // 3	Windows specific revision number (under Windows only)
 
 	uint32 bHasCatFileWithFilters : 1;
+	uint32 bHasPathspecFromFile : 1;
+	uint32 bHasNoOptionalLocks : 1;
 	uint32 bHasGitLfs : 1;
 	uint32 bHasGitLfsLocking : 1;
 
@@ -39,6 +48,8 @@ struct FGitVersion
 		, Patch(0)
 		, Windows(0)
 		, bHasCatFileWithFilters(false)
+		, bHasPathspecFromFile(false)
+		, bHasNoOptionalLocks(false)
 		, bHasGitLfs(false)
 		, bHasGitLfsLocking(false)
 	{
@@ -55,6 +66,8 @@ class FGitSourceControlProvider : public ISourceControlProvider
 public:
 	/** Constructor */
 	FGitSourceControlProvider()
+		: CatFileBatch(false)
+		, CatFileBatchCheck(true)
 	{
 	}
 
@@ -152,21 +165,104 @@ public:
 		return RemoteUrl;
 	}
 
+	/** Long-lived "git cat-file --batch" process to read the content of files at any revision */
+	inline FGitCatFileBatch& GetCatFileBatch()
+	{
+		return CatFileBatch;
+	}
+
+	/** Long-lived "git cat-file --batch-check" process to get the id and size of files at any revision */
+	inline FGitCatFileBatch& GetCatFileBatchCheck()
+	{
+		return CatFileBatchCheck;
+	}
+
+	/** Cache of the Git LFS locks of the repository */
+	inline FGitLfsLockCache& GetLfsLockCache()
+	{
+		return LfsLockCache;
+	}
+
+	/** Reader of the refs and config of the repository, without launching Git */
+	inline FGitRepositoryReader& GetRepositoryReader()
+	{
+		return RepositoryReader;
+	}
+
 	/** Helper function used to update state cache */
 	TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe> GetStateInternal(const FString& Filename);
 
+	/**
+	 * Helper function used to update state cache: replace the cached state by a new one, keeping the indices of the cache up to date,
+	 * unless the cached one comes from a command issued after the one being applied
+	 */
+	void UpdateStateInternal(FGitSourceControlState&& InState, const FDateTime& InTimeStamp);
+
+	/**
+	 * Register to be notified of the files whose displayed state changed, instead of re-querying all the states on each change
+	 * (identical states are not notified, and all the changes of a tick are notified at once)
+	 */
+	FDelegateHandle RegisterFilesChanged_Handle(const FGitSourceControlFilesChanged::FDelegate& InFilesChanged);
+
+	/** Unregister from the notifications of the files whose displayed state changed */
+	void UnregisterFilesChanged_Handle(FDelegateHandle InHandle);
+
+	/**
+	 * Throttle the fetches from the remote server: tells if the last one is older than the given interval,
+	 * and if so, consider that a new one starts now (can be called from any worker thread)
+	 */
+	bool TryStartFetch(const double InMinInterval);
+
 	/**
 	 * Register a worker with the provider.
 	 * This is used internally so the provider can maintain a map of all available operations.
 	 */
 	void RegisterWorker( const FName& InName, const FGetGitSourceControlWorker& InDelegate );
 
+	/**
+	 * Take the files to reconcile with the state snapshot loaded at startup, if any, only once
+	 *
+	 * @param	OutFiles	The files that were not unchanged (or were locked) in the snapshot
+	 * @returns true if a snapshot was loaded, so that a status of the changes is enough to reconcile it
+	 */
+	bool ConsumeStateSnapshot(TArray<FString>& OutFiles);
+
 	/** Remove a named file from the state cache */
 	bool RemoveFileFromCache(const FString& Filename);
 
 	/** Get files in cache */
 	TArray<FString> GetFilesInCache();
 
+	/** Get files in cache in any of the given categories (a combination of EGitStateIndex flags), without scanning the whole cache */
+	TArray<FString> GetFilesInCache(const uint32 InIndices) const;
+
+	/** Get the cached states in any of the given categories (a combination of EGitStateIndex flags), without scanning the whole cache */
+	TArray<FSourceControlStateRef> GetCachedStatesByIndex(const uint32 InIndices) const;
+
+	/** Get files in cache under a directory, in any of the given categories or all of them if None, without scanning the whole cache */
+	TArray<FString> GetFilesInCache(const FString& InDirectory, const uint32 InIndices) const;
+
+	/** Get the counts of files in cache under a directory, by category */
+	FGitDirectoryStateCounts GetDirectoryStateCounts(const FString& InDirectory) const;
+
+	/** Get the statistics of the worker threads executing the commands (queue depth and wait times by priority class) */
+	FGitSchedulerStats GetSchedulerStats() const
+	{
+		return Scheduler.GetStats();
+	}
+
+	/**
+	 * Consider the remote offline for a while, after a Git command contacting it timed out (circuit breaker):
+	 * the next ones fail right away instead of each blocking a worker thread until its own timeout
+	 */
+	void MarkRemoteOffline();
+
+	/**
+	 * Tells if the remote is considered offline (see MarkRemoteOffline())
+	 * @param	OutRemainingTime	Time before the next Git command is allowed to contact the remote again, in seconds
+	 */
+	bool IsRemoteOffline(double& OutRemainingTime) const;
+
 private:
 
 	/** Is git binary found and working. */
@@ -181,6 +277,30 @@ private:
 	/** Helper function for Execute() */
 	TSharedPtr<class IGitSourceControlWorker, ESPMode::ThreadSafe> CreateWorker(const FName& InOperationName) const;
 
+	/** Priority class of a command, to schedule it (see FGitSourceControlScheduler) */
+	static EGitCommandPriority::Type GetCommandPriority(const class FGitSourceControlCommand& InCommand);
+
+	/**
+	 * Tells if a command writes to the repository, so that it never runs concurrently with another one writing to it.
+	 * Without "--no-optional-locks" (before Git 2.15), "git status" takes the lock of the index too, so every command counts as a write.
+	 */
+	bool IsWriteCommand(const class FGitSourceControlCommand& InCommand) const;
+
+	/** Gather an asynchronous write command (add, delete, copy) with the consecutive ones of the same kind issued within a short time window */
+	ECommandResult::Type IssueBatchedCommand(class FGitSourceControlCommand& InCommand);
+
+	/** Issue the batched write command, either only if gathered long enough, or in any case (to keep the order of the operations) */
+	void FlushBatchedCommand(const bool bInForce);
+
+	/** Issue an asynchronous UpdateStatus command: merged into a deferred one if possible, else deferred if too many are already running */
+	ECommandResult::Type IssueUpdateStatusCommand(class FGitSourceControlCommand& InCommand);
+
+	/** Issue the deferred UpdateStatus commands, as long as not too many are running */
+	void IssueDeferredUpdateStatusCommands();
+
+	/** Find the command of an operation (its own one, or merged into it and not detached), either running, queued, deferred or batched, to cancel it */
+	class FGitSourceControlCommand* FindCommand(const FSourceControlOperationRef& InOperation) const;
+
 	/** Helper function for running command synchronously. */
 	ECommandResult::Type ExecuteSynchronousCommand(class FGitSourceControlCommand& InCommand, const FText& Task);
 	/** Issue a command asynchronously if possible. */
@@ -192,6 +312,21 @@ private:
 	/** Update repository status on Connect and UpdateStatus operations */
 	void UpdateRepositoryStatus(const class FGitSourceControlCommand& InCommand);
 
+	/** Save the state cache into a snapshot file, keyed by the current commit and index of the repository */
+	void SaveStateSnapshot();
+
+	/** Load the state cache from the snapshot file, if it is still for the current commit and index of the repository */
+	void LoadStateSnapshot();
+
+	/** Record files whose displayed state changed, to be notified by the next Tick() */
+	void AddChangedFiles(const TArray<FString>& InFilenames);
+
+	/** Notify the files whose displayed state changed, if any, all at once */
+	void BroadcastChangedFiles();
+
+	/** Apply to the cached states the Git LFS locks taken or released by others, found by a background refresh of the locks */
+	void UpdateChangedLocks();
+
 	/** Path to the root of the Git repository: can be the ProjectDir itself, or any parent directory (found by the "Connect" operation) */
 	FString PathToRepositoryRoot;
 
@@ -213,8 +348,8 @@ private:
 	/** Current Commit description's Summary */
 	FString CommitSummary;
 
-	/** State cache */
-	TMap<FString, TSharedRef<class FGitSourceControlState, ESPMode::ThreadSafe> > StateCache;
+	/** State cache (thread-safe, so that workers can query it) */
+	FGitSourceControlStateCache StateCache;
 
 	/** The currently registered source control operations */
 	TMap<FName, FGetGitSourceControlWorker> WorkersMap;
@@ -222,12 +357,81 @@ private:
 	/** Queue for commands given by the main thread */
 	TArray < FGitSourceControlCommand* > CommandQueue;
 
+	/** Dedicated worker threads executing the commands */
+	FGitSourceControlScheduler Scheduler;
+
+	/** Asynchronous write command gathering the consecutive operations of the same kind, not issued yet (see IssueBatchedCommand()) */
+	FGitSourceControlCommand* BatchedCommand = nullptr;
+
+	/** Time of the first operation of the batched command (FPlatformTime::Seconds()) */
+	double BatchStartTime = 0.0;
+
+	/** Asynchronous UpdateStatus commands waiting for one of the running ones to complete, before being issued (so they can still be merged) */
+	TArray < FGitSourceControlCommand* > DeferredUpdateStatusCommands;
+
+	/** Number of asynchronous UpdateStatus commands issued to the thread pool and not completed yet */
+	int32 NumRunningUpdateStatusCommands = 0;
+
+	/** Generation of the last command issued */
+	uint32 LastCommandGeneration = 0;
+
+	/** Generation of the command whose states are being applied, by Tick() */
+	uint32 ApplyingGeneration = 0;
+
+	/** Commands completed by the worker threads, in their order of completion */
+	FGitCompletedCommandQueue CompletedCommands;
+
+	/** Completed commands to finalize on the game thread, in order (the first one can be applying its results over a few ticks) */
+	TArray < FGitSourceControlCommand* > ReadyCommands;
+
 	/** For notifying when the source control states in the cache have changed */
 	FSourceControlStateChanged OnSourceControlStateChanged;
 
+	/** For notifying which files had their displayed state changed */
+	FGitSourceControlFilesChanged OnFilesChanged;
+
+	/** Files whose displayed state changed since the last notification, notified by the next Tick() */
+	TSet<FString> ChangedFiles;
+
+	/** Critical section for thread safety of the changed files (states can be removed by worker threads) */
+	FCriticalSection ChangedFilesCriticalSection;
+
+	/** Time until which the remote is considered offline (FPlatformTime::Seconds()), see MarkRemoteOffline() */
+	double RemoteOfflineUntil = 0.0;
+
+	/** Critical section for thread safety of the offline status of the remote (Git commands time out on worker threads) */
+	mutable FCriticalSection RemoteOfflineCriticalSection;
+
 	/** Git version for feature checking */
 	FGitVersion GitVersion;
 
+	/** Time of the last fetch from the remote server (FPlatformTime::Seconds()), to throttle them */
+	double LastFetchTime = 0.0;
+
+	/** Critical section for thread safety of the last fetch time */
+	FCriticalSection LastFetchCriticalSection;
+
+	/** Long-lived "git cat-file --batch" process */
+	FGitCatFileBatch CatFileBatch;
+
+	/** Long-lived "git cat-file --batch-check" process */
+	FGitCatFileBatch CatFileBatchCheck;
+
+	/** Cache of the Git LFS locks */
+	FGitLfsLockCache LfsLockCache;
+
+	/** Reader of the refs and config of the repository */
+	FGitRepositoryReader RepositoryReader;
+
+	/** Files to reconcile with the state snapshot loaded at startup (see ConsumeStateSnapshot()) */
+	TArray<FString> StateSnapshotFiles;
+
+	/** Tells if a state snapshot was loaded and not reconciled yet */
+	bool bStateSnapshotLoaded = false;
+
+	/** Critical section for thread safety of the state snapshot */
+	FCriticalSection StateSnapshotCriticalSection;
+
 	/** Source Control Menu Extension */
 	FGitSourceControlMenu GitSourceControlMenu;
 
@@ -0,0 +1,588 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#include "GitSourceControlRepository.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+namespace GitRepositoryConstants
+{
+	/** A file modified less than this number of seconds before being read could be modified again without changing its timestamp, so it is read again */
+	const double RacyInterval = 2.0;
+
+	/** Maximum number of symbolic refs to follow (same as Git) */
+	const int32 MaxSymbolicRefDepth = 5;
+}
+
+/** Tells if a string is a full SHA1 (40 hex chars) or SHA256 (64 hex chars) object id */
+static bool IsObjectId(const FString& InString)
+{
+	if((InString.Len() != 40) && (InString.Len() != 64))
+	{
+		return false;
+	}
+	for(const TCHAR Char : InString)
+	{
+		if(!FChar::IsHexDigit(Char))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Parse the "packed-refs" file of a repository
+ *
+ * Example content of a "packed-refs" file:
+# pack-refs with: peeled fully-peeled sorted
+d9b33098273547b57c0af314136f35b494e16dcb refs/heads/main
+a14347dc3b589b78fb19ba62a7e3982f343718bc refs/remotes/origin/main
+f3137a7167c840847cd7bd2bf07eefbfb2d9bcd2 refs/tags/v1.0
+^7e3e2a9a4a4cd2d8e0c1d4f5b2bcb7a3b8b4c1f0
+ */
+template<typename MapType>
+static void ParsePackedRefs(const FString& InContent, MapType& OutRefs)
+{
+	TArray<FString> Lines;
+	InContent.ParseIntoArrayLines(Lines);
+	for(const FString& Line : Lines)
+	{
+		// Skip the header, and the commits pointed to by the annotated tag of the previous line
+		if(Line.StartsWith(TEXT("#")) || Line.StartsWith(TEXT("^")))
+		{
+			continue;
+		}
+		int32 SpaceIndex;
+		if(Line.FindChar(TEXT(' '), SpaceIndex))
+		{
+			OutRefs.Add(Line.RightChop(SpaceIndex + 1), Line.Left(SpaceIndex));
+		}
+	}
+}
+
+/** Parse the value of a config variable: remove comments and surrounding whitespaces, handle quotes and escape sequences */
+static FString ParseConfigValue(const FString& InRawValue)
+{
+	FString Value;
+	int32 SignificantLen = 0; // to trim trailing whitespaces, except quoted ones
+	bool bInQuotes = false;
+	for(int32 Index = 0; Index < InRawValue.Len(); ++Index)
+	{
+		const TCHAR Char = InRawValue[Index];
+		if((Char == TEXT('\\')) && (Index + 1 < InRawValue.Len()))
+		{
+			const TCHAR Escaped = InRawValue[++Index];
+			switch(Escaped)
+			{
+			case TEXT('n'): Value.AppendChar(TEXT('\n')); break;
+			case TEXT('t'): Value.AppendChar(TEXT('\t')); break;
+			case TEXT('b'): Value.AppendChar(TEXT('\b')); break;
+			default: Value.AppendChar(Escaped); break;
+			}
+			SignificantLen = Value.Len();
+		}
+		else if(Char == TEXT('"'))
+		{
+			bInQuotes = !bInQuotes;
+			SignificantLen = Value.Len();
+		}
+		else if(!bInQuotes && ((Char == TEXT('#')) || (Char == TEXT(';'))))
+		{
+			break;
+		}
+		else if(!bInQuotes && FChar::IsWhitespace(Char))
+		{
+			if(!Value.IsEmpty())
+			{
+				Value.AppendChar(Char);
+			}
+		}
+		else
+		{
+			Value.AppendChar(Char);
+			SignificantLen = Value.Len();
+		}
+	}
+	Value.LeftInline(SignificantLen, false);
+	return Value;
+}
+
+/**
+ * Parse the "config" file of a repository into "section.subsection.key" => value (the last one for multi-valued variables)
+ *
+ * Section and key names are case-insensitive, so they are lower-cased, but subsection names are case-sensitive (so are the keys of the map).
+ * NOTE: "include.path" and "includeIf" are not followed (see FGitRepositoryReader::ReadConfigs())
+ *
+ * Example content of a "config" file:
+[core]
+	repositoryformatversion = 0
+	bare = false
+[remote "origin"]
+	url = https://github.com/SRombauts/UEGitPlugin.git
+	fetch = +refs/heads/*:refs/remotes/origin/*
+[branch "main"]
+	remote = origin
+	merge = refs/heads/main
+ */
+template<typename MapType>
+static void ParseConfig(const FString& InContent, MapType& OutValues)
+{
+	FString Prefix;
+	TArray<FString> Lines;
+	InContent.ParseIntoArrayLines(Lines, false);
+	for(int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		FString Line = Lines[LineIndex].TrimStartAndEnd();
+		// A value can continue on the next lines, after a backslash at the end of the line
+		while(Line.EndsWith(TEXT("\\")) && !Line.EndsWith(TEXT("\\\\")) && (LineIndex + 1 < Lines.Num()))
+		{
+			Line.LeftChopInline(1, false);
+			Line += Lines[++LineIndex];
+			Line.TrimEndInline();
+		}
+		if(Line.IsEmpty() || Line.StartsWith(TEXT("#")) || Line.StartsWith(TEXT(";")))
+		{
+			continue;
+		}
+
+		if(Line.StartsWith(TEXT("[")))
+		{
+			int32 EndIndex;
+			if(!Line.FindLastChar(TEXT(']'), EndIndex))
+			{
+				Prefix.Reset();
+				continue;
+			}
+			const FString Header = Line.Mid(1, EndIndex - 1);
+			int32 QuoteIndex;
+			int32 DotIndex;
+			if(Header.FindChar(TEXT('"'), QuoteIndex))
+			{
+				// [section "subsection"]
+				Prefix = Header.Left(QuoteIndex).TrimEnd().ToLower() + TEXT(".") + ParseConfigValue(Header.RightChop(QuoteIndex));
+			}
+			else if(Header.FindChar(TEXT('.'), DotIndex))
+			{
+				// [section.subsection] (deprecated syntax, subsection is case-insensitive)
+				Prefix = Header.ToLower();
+			}
+			else
+			{
+				// [section]
+				Prefix = Header.TrimStartAndEnd().ToLower();
+			}
+			continue;
+		}
+
+		if(Prefix.IsEmpty())
+		{
+			continue;
+		}
+		int32 EqualIndex;
+		if(Line.FindChar(TEXT('='), EqualIndex))
+		{
+			const FString Name = Line.Left(EqualIndex).TrimEnd().ToLower();
+			OutValues.Add(Prefix + TEXT(".") + Name, ParseConfigValue(Line.RightChop(EqualIndex + 1)));
+		}
+		else
+		{
+			// A variable without value is a boolean true
+			OutValues.Add(Prefix + TEXT(".") + Line.ToLower(), TEXT("true"));
+		}
+	}
+}
+
+void FGitRepositoryReader::Reset()
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	Files.Reset();
+}
+
+TSharedPtr<FGitRepositoryReader::FCachedFile> FGitRepositoryReader::ReadFile(const FString& InFilename)
+{
+	const FFileStatData Stat = IFileManager::Get().GetStatData(*InFilename);
+	if(!Stat.bIsValid || Stat.bIsDirectory)
+	{
+		Files.Remove(InFilename);
+		return nullptr;
+	}
+
+	if(const TSharedPtr<FCachedFile>* CachedFile = Files.Find(InFilename))
+	{
+		const FCachedFile& File = **CachedFile;
+		if((File.ModificationTime == Stat.ModificationTime) && (File.Size == Stat.FileSize) && ((File.ReadTime - File.ModificationTime).GetTotalSeconds() > GitRepositoryConstants::RacyInterval))
+		{
+			return *CachedFile;
+		}
+	}
+
+	// A new object for each read, so that the previous content stays valid for whoever is still using it
+	TSharedPtr<FCachedFile> File = MakeShared<FCachedFile>();
+	File->ModificationTime = Stat.ModificationTime;
+	File->Size = Stat.FileSize;
+	File->ReadTime = FDateTime::UtcNow();
+	if(!FFileHelper::LoadFileToString(File->Content, *InFilename))
+	{
+		Files.Remove(InFilename);
+		return nullptr;
+	}
+	Files.Add(InFilename, File);
+	return File;
+}
+
+bool FGitRepositoryReader::GetDirectories(const FString& InRepositoryRoot, FGitDirectories& OutDirectories)
+{
+	const FString DotGit = InRepositoryRoot / TEXT(".git");
+	if(IFileManager::Get().DirectoryExists(*DotGit))
+	{
+		OutDirectories.GitDir = DotGit;
+	}
+	else if(const TSharedPtr<FCachedFile> GitFile = ReadFile(DotGit))
+	{
+		// Worktrees and submodules have a ".git" file with the path to their Git directory, ie. "gitdir: ../.git/worktrees/Feature"
+		const FString Content = GitFile->Content.TrimStartAndEnd();
+		if(!Content.StartsWith(TEXT("gitdir:")))
+		{
+			return false;
+		}
+		OutDirectories.GitDir = FPaths::ConvertRelativePathToFull(InRepositoryRoot, Content.RightChop(7).TrimStart());
+	}
+	else
+	{
+		return false;
+	}
+
+	// Worktrees share the refs and config of the main repository, given by their "commondir" file
+	OutDirectories.CommonDir = OutDirectories.GitDir;
+	if(const TSharedPtr<FCachedFile> CommonDirFile = ReadFile(OutDirectories.GitDir / TEXT("commondir")))
+	{
+		OutDirectories.CommonDir = FPaths::ConvertRelativePathToFull(OutDirectories.GitDir, CommonDirFile->Content.TrimStartAndEnd());
+	}
+
+	// The "reftable" format of refs is binary: let Git read it
+	return !IFileManager::Get().DirectoryExists(*(OutDirectories.CommonDir / TEXT("reftable")));
+}
+
+TSharedPtr<FGitRepositoryReader::FCachedFile> FGitRepositoryReader::ReadParsedFile(const FString& InFilename, const bool bInConfig)
+{
+	TSharedPtr<FCachedFile> File = ReadFile(InFilename);
+	if(File.IsValid() && !File->bParsed)
+	{
+		if(bInConfig)
+		{
+			ParseConfig(File->Content, File->Values);
+		}
+		else
+		{
+			ParsePackedRefs(File->Content, File->Values);
+		}
+		File->bParsed = true;
+	}
+	return File;
+}
+
+bool FGitRepositoryReader::ReadConfigs(const FGitDirectories& InDirectories, TArray<TSharedPtr<FCachedFile>>& OutConfigs)
+{
+	// The global config of the user, in the same order as Git (see "git help config")
+	const FString XdgConfigHome = FPlatformMisc::GetEnvironmentVariable(TEXT("XDG_CONFIG_HOME"));
+	FString Home = FPlatformMisc::GetEnvironmentVariable(TEXT("HOME"));
+#if PLATFORM_WINDOWS
+	if(Home.IsEmpty())
+	{
+		Home = FPlatformMisc::GetEnvironmentVariable(TEXT("USERPROFILE"));
+	}
+#endif
+	TArray<FString> Filenames;
+	if(!XdgConfigHome.IsEmpty())
+	{
+		Filenames.Add(XdgConfigHome / TEXT("git/config"));
+	}
+	else if(!Home.IsEmpty())
+	{
+		Filenames.Add(Home / TEXT(".config/git/config"));
+	}
+	if(!Home.IsEmpty())
+	{
+		Filenames.Add(Home / TEXT(".gitconfig"));
+	}
+	for(const FString& Filename : Filenames)
+	{
+		if(TSharedPtr<FCachedFile> Config = ReadParsedFile(FPaths::ConvertRelativePathToFull(Filename), true))
+		{
+			OutConfigs.Add(MoveTemp(Config));
+		}
+	}
+
+	// then the one of the repository
+	TSharedPtr<FCachedFile> Config = ReadParsedFile(InDirectories.CommonDir / TEXT("config"), true);
+	if(!Config.IsValid())
+	{
+		return false;
+	}
+	OutConfigs.Add(MoveTemp(Config));
+
+	for(const TSharedPtr<FCachedFile>& ParsedConfig : OutConfigs)
+	{
+		for(const auto& Value : ParsedConfig->Values)
+		{
+			if(Value.Key.StartsWith(TEXT("include.")) || Value.Key.StartsWith(TEXT("includeif.")))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+const FString* FGitRepositoryReader::FindConfigValue(const TArray<TSharedPtr<FCachedFile>>& InConfigs, const FString& InName)
+{
+	for(int32 Index = InConfigs.Num() - 1; Index >= 0; --Index)
+	{
+		if(const FString* Value = InConfigs[Index]->Values.Find(InName))
+		{
+			return Value;
+		}
+	}
+	return nullptr;
+}
+
+bool FGitRepositoryReader::ResolveRef(const FGitDirectories& InDirectories, const FString& InRefName, FString& OutCommitId)
+{
+	FString RefName = InRefName;
+	for(int32 Depth = 0; Depth < GitRepositoryConstants::MaxSymbolicRefDepth; ++Depth)
+	{
+		// HEAD and a few refs are specific to each worktree, all the others are shared
+		const bool bPerWorktree = (RefName == TEXT("HEAD")) || RefName.StartsWith(TEXT("refs/worktree/")) || RefName.StartsWith(TEXT("refs/bisect/"));
+		if(const TSharedPtr<FCachedFile> LooseRef = ReadFile((bPerWorktree ? InDirectories.GitDir : InDirectories.CommonDir) / RefName))
+		{
+			const FString Content = LooseRef->Content.TrimStartAndEnd();
+			if(Content.StartsWith(TEXT("ref:")))
+			{
+				RefName = Content.RightChop(4).TrimStart();
+				continue;
+			}
+			if(!IsObjectId(Content))
+			{
+				return false;
+			}
+			OutCommitId = Content;
+			return true;
+		}
+
+		if(const TSharedPtr<FCachedFile> PackedRefs = ReadParsedFile(InDirectories.CommonDir / TEXT("packed-refs"), false))
+		{
+			if(const FString* CommitId = PackedRefs->Values.Find(RefName))
+			{
+				OutCommitId = *CommitId;
+				return true;
+			}
+		}
+
+		// The ref does not exist (yet), ie. a branch before its first commit
+		OutCommitId.Reset();
+		return true;
+	}
+	return false;
+}
+
+bool FGitRepositoryReader::ReadHead(const FGitDirectories& InDirectories, FString& OutBranchRef, FString& OutCommitId)
+{
+	OutBranchRef.Reset();
+	OutCommitId.Reset();
+	const TSharedPtr<FCachedFile> Head = ReadFile(InDirectories.GitDir / TEXT("HEAD"));
+	if(!Head.IsValid())
+	{
+		return false;
+	}
+	const FString Content = Head->Content.TrimStartAndEnd();
+	if(Content.StartsWith(TEXT("ref:")))
+	{
+		OutBranchRef = Content.RightChop(4).TrimStart();
+		return true;
+	}
+	if(IsObjectId(Content))
+	{
+		OutCommitId = Content; // detached HEAD
+		return true;
+	}
+	return false;
+}
+
+bool FGitRepositoryReader::GetBranchName(const FString& InRepositoryRoot, FString& OutBranchName)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	FGitDirectories Directories;
+	FString BranchRef;
+	FString CommitId;
+	if(!GetDirectories(InRepositoryRoot, Directories) || !ReadHead(Directories, BranchRef, CommitId))
+	{
+		return false;
+	}
+	if(!BranchRef.IsEmpty())
+	{
+		// Short name of the branch, like "git symbolic-ref --short HEAD"
+		OutBranchName = BranchRef.StartsWith(TEXT("refs/heads/")) ? BranchRef.RightChop(11) : BranchRef;
+	}
+	else
+	{
+		// Detached HEAD: let Git give the short id of the commit, long enough to be unique in the repository
+		return false;
+	}
+	return true;
+}
+
+bool FGitRepositoryReader::GetCommitId(const FString& InRepositoryRoot, FString& OutCommitId)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	FGitDirectories Directories;
+	FString BranchRef;
+	if(!GetDirectories(InRepositoryRoot, Directories) || !ReadHead(Directories, BranchRef, OutCommitId))
+	{
+		return false;
+	}
+	return BranchRef.IsEmpty() || ResolveRef(Directories, BranchRef, OutCommitId);
+}
+
+bool FGitRepositoryReader::GetUpstream(const FString& InRepositoryRoot, FString& OutUpstreamRef, FString& OutUpstreamCommitId)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	OutUpstreamRef.Reset();
+	OutUpstreamCommitId.Reset();
+	FGitDirectories Directories;
+	FString BranchRef;
+	FString CommitId;
+	if(!GetDirectories(InRepositoryRoot, Directories) || !ReadHead(Directories, BranchRef, CommitId))
+	{
+		return false;
+	}
+	if(!BranchRef.StartsWith(TEXT("refs/heads/")))
+	{
+		return true; // detached HEAD: no upstream
+	}
+
+	TArray<TSharedPtr<FCachedFile>> Configs;
+	if(!ReadConfigs(Directories, Configs))
+	{
+		return false;
+	}
+	const FString BranchName = BranchRef.RightChop(11);
+	const FString* Remote = FindConfigValue(Configs, TEXT("branch.") + BranchName + TEXT(".remote"));
+	const FString* Merge = FindConfigValue(Configs, TEXT("branch.") + BranchName + TEXT(".merge"));
+	if(!Remote || !Merge)
+	{
+		return true; // no upstream configured
+	}
+	if(*Remote == TEXT("."))
+	{
+		// Upstream is a local branch
+		OutUpstreamRef = *Merge;
+	}
+	else if(Merge->StartsWith(TEXT("refs/heads/")))
+	{
+		// NOTE: assume the default fetch refspec "+refs/heads/*:refs/remotes/<remote>/*"
+		OutUpstreamRef = TEXT("refs/remotes/") + *Remote + TEXT("/") + Merge->RightChop(11);
+	}
+	else
+	{
+		return true;
+	}
+	return ResolveRef(Directories, OutUpstreamRef, OutUpstreamCommitId);
+}
+
+bool FGitRepositoryReader::GetRemoteUrl(const FString& InRepositoryRoot, const FString& InRemoteName, FString& OutRemoteUrl)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	OutRemoteUrl.Reset();
+	FGitDirectories Directories;
+	if(!GetDirectories(InRepositoryRoot, Directories))
+	{
+		return false;
+	}
+	TArray<TSharedPtr<FCachedFile>> Configs;
+	if(!ReadConfigs(Directories, Configs))
+	{
+		return false;
+	}
+	const FString* Url = FindConfigValue(Configs, TEXT("remote.") + InRemoteName + TEXT(".url"));
+	if(!Url)
+	{
+		return true;
+	}
+
+	// Rewrite the URL with the longest matching "url.<base>.insteadOf" prefix of any config file, like "git remote get-url"
+	OutRemoteUrl = *Url;
+	int32 LongestPrefix = 0;
+	for(const TSharedPtr<FCachedFile>& Config : Configs)
+	{
+		for(const auto& Value : Config->Values)
+		{
+			if(Value.Key.StartsWith(TEXT("url.")) && Value.Key.EndsWith(TEXT(".insteadof")) && (Value.Value.Len() > LongestPrefix) && Url->StartsWith(Value.Value))
+			{
+				LongestPrefix = Value.Value.Len();
+				OutRemoteUrl = Value.Key.Mid(4, Value.Key.Len() - 14) + Url->RightChop(LongestPrefix);
+			}
+		}
+	}
+	return true;
+}
+
+bool FGitRepositoryReader::GetIndexChecksum(const FString& InRepositoryRoot, FString& OutIndexChecksum)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	OutIndexChecksum.Reset();
+	FGitDirectories Directories;
+	if(!GetDirectories(InRepositoryRoot, Directories))
+	{
+		return false;
+	}
+
+	// The index can be big: only read its trailing SHA1 (the last bytes of a SHA256 are as good to detect a change)
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*(Directories.GitDir / TEXT("index")), FILEREAD_Silent));
+	if(!Reader.IsValid())
+	{
+		return true;
+	}
+	const int64 ChecksumSize = 20;
+	if(Reader->TotalSize() < ChecksumSize)
+	{
+		return false;
+	}
+	uint8 Checksum[ChecksumSize];
+	Reader->Seek(Reader->TotalSize() - ChecksumSize);
+	Reader->Serialize(Checksum, ChecksumSize);
+	if(!Reader->Close())
+	{
+		return false;
+	}
+	OutIndexChecksum = BytesToHex(Checksum, ChecksumSize);
+	return true;
+}
+
+bool FGitRepositoryReader::FindCommitSummary(const FString& InCommitId, FString& OutCommitSummary)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	if(const FString* CommitSummary = CommitSummaries.Find(InCommitId))
+	{
+		OutCommitSummary = *CommitSummary;
+		return true;
+	}
+	return false;
+}
+
+void FGitRepositoryReader::AddCommitSummary(const FString& InCommitId, const FString& InCommitSummary)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	CommitSummaries.Add(InCommitId, InCommitSummary);
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+/**
+ * Reader of the files of the ".git/" directory, owned by the provider, to get the current branch, commit and upstream without launching Git.
+ *
+ * Reads ".git/HEAD", the loose refs, "packed-refs" and ".git/config", following the "gitdir:" file of worktrees and submodules,
+ * along with the global config of the user ("~/.gitconfig" and "$XDG_CONFIG_HOME/git/config"), but not the system one.
+ * Files are cached along with their timestamp and size, and read again only when they changed.
+ * Every method returns false when the repository cannot be read this way (ie. "reftable" format, or a config including other files),
+ * so that the caller can fall back on Git.
+ * Can be used from any worker thread.
+ */
+class FGitRepositoryReader
+{
+public:
+	/** Forget all cached files (but not the summaries of commits) */
+	void Reset();
+
+	/**
+	 * Get the current checked-out branch
+	 *
+	 * @param	InRepositoryRoot	The root of the Git repository
+	 * @param	OutBranchName		Name of the current checked-out branch
+	 * @returns false also for a detached HEAD, since the length of its short id ("%h") depends on the objects of the repository
+	 */
+	bool GetBranchName(const FString& InRepositoryRoot, FString& OutBranchName);
+
+	/**
+	 * Get the current commit
+	 *
+	 * @param	InRepositoryRoot	The root of the Git repository
+	 * @param	OutCommitId			Current Commit full SHA1 (empty before the first commit)
+	 */
+	bool GetCommitId(const FString& InRepositoryRoot, FString& OutCommitId);
+
+	/**
+	 * Get the upstream branch of the current branch ("branch.<name>.remote" and "branch.<name>.merge" config)
+	 *
+	 * @param	InRepositoryRoot	The root of the Git repository
+	 * @param	OutUpstreamRef		Full name of the remote-tracking branch, ie. "refs/remotes/origin/main", or empty if none
+	 * @param	OutUpstreamCommitId	Full SHA1 of the remote-tracking branch as of the last fetch, or empty if none
+	 */
+	bool GetUpstream(const FString& InRepositoryRoot, FString& OutUpstreamRef, FString& OutUpstreamCommitId);
+
+	/**
+	 * Get the URL of a remote ("remote.<name>.url" config, rewritten by any "url.<base>.insteadOf" config)
+	 *
+	 * @param	InRepositoryRoot	The root of the Git repository
+	 * @param	InRemoteName		Name of the remote, ie. "origin"
+	 * @param	OutRemoteUrl		URL of the remote, or empty if none
+	 */
+	bool GetRemoteUrl(const FString& InRepositoryRoot, const FString& InRemoteName, FString& OutRemoteUrl);
+
+	/**
+	 * Get the checksum of the index (the trailing hash of the ".git/index" file), that changes with any change to the staging area
+	 *
+	 * @param	InRepositoryRoot	The root of the Git repository
+	 * @param	OutIndexChecksum	Hexadecimal checksum of the index, or empty if there is no index yet
+	 */
+	bool GetIndexChecksum(const FString& InRepositoryRoot, FString& OutIndexChecksum);
+
+	/** Find the summary of a commit read before (commits never change) */
+	bool FindCommitSummary(const FString& InCommitId, FString& OutCommitSummary);
+
+	/** Remember the summary of a commit */
+	void AddCommitSummary(const FString& InCommitId, const FString& InCommitSummary);
+
+private:
+	/** Ref names and config variables with a subsection (ie. a branch name) are case-sensitive, unlike FString keys by default */
+	struct FCaseSensitiveKeyFuncs : BaseKeyFuncs<TPair<FString, FString>, FString, false>
+	{
+		static const FString& GetSetKey(const TPair<FString, FString>& InElement)
+		{
+			return InElement.Key;
+		}
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+		static uint32 GetKeyHash(const FString& InKey)
+		{
+			return FCrc::StrCrc32(*InKey);
+		}
+	};
+
+	/** Content of a file of the ".git/" directory, with its parsed values (by name) for "packed-refs" and "config" */
+	struct FCachedFile
+	{
+		FDateTime ModificationTime;
+		int64 Size = 0;
+		FDateTime ReadTime;
+		FString Content;
+		bool bParsed = false;
+		TMap<FString, FString, FDefaultSetAllocator, FCaseSensitiveKeyFuncs> Values;
+	};
+
+	/** Directories of a repository: the one of the worktree (for HEAD) and the common one (for refs and config) */
+	struct FGitDirectories
+	{
+		FString GitDir;
+		FString CommonDir;
+	};
+
+	/** Find the directories of a repository, with the critical section held */
+	bool GetDirectories(const FString& InRepositoryRoot, FGitDirectories& OutDirectories);
+
+	/** Read a file, or get it from the cache if it did not change, with the critical section held */
+	TSharedPtr<FCachedFile> ReadFile(const FString& InFilename);
+
+	/** Read and parse the "config" file ("section.subsection.key" => value) or the "packed-refs" file (ref name => commit id), with the critical section held */
+	TSharedPtr<FCachedFile> ReadParsedFile(const FString& InFilename, const bool bInConfig);
+
+	/**
+	 * Read the config files, by increasing precedence (the global ones, then the one of the repository), with the critical section held
+	 * @returns false if the config of the repository cannot be read, or if any of them includes other files ("include.path" or "includeIf", not followed)
+	 */
+	bool ReadConfigs(const FGitDirectories& InDirectories, TArray<TSharedPtr<FCachedFile>>& OutConfigs);
+
+	/** Find the value of a config variable in the config files, the one of the repository first */
+	static const FString* FindConfigValue(const TArray<TSharedPtr<FCachedFile>>& InConfigs, const FString& InName);
+
+	/** Resolve a ref to a commit id, following symbolic refs, with the critical section held */
+	bool ResolveRef(const FGitDirectories& InDirectories, const FString& InRefName, FString& OutCommitId);
+
+	/** Read the HEAD of the worktree, with the critical section held: either the full name of the current branch, or the id of the detached commit */
+	bool ReadHead(const FGitDirectories& InDirectories, FString& OutBranchRef, FString& OutCommitId);
+
+private:
+	/** Critical section for thread safety of the cache */
+	FCriticalSection CriticalSection;
+
+	/** Files of the ".git/" directories, by absolute filename */
+	TMap<FString, TSharedPtr<FCachedFile>> Files;
+
+	/** Summaries of commits, by commit id */
+	TMap<FString, FString> CommitSummaries;
+};
@@ -0,0 +1,287 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#include "GitSourceControlScheduler.h"
+
+#include "Algo/BinarySearch.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/IQueuedWork.h"
+#include "Misc/ScopeLock.h"
+#include "ISourceControlModule.h"
+
+FGitSourceControlScheduler::~FGitSourceControlScheduler()
+{
+	Stop();
+}
+
+void FGitSourceControlScheduler::Start(const int32 InNumWorkers)
+{
+	check(!IsStarted());
+
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		bStopping = false;
+		NumWorkers = FMath::Max(InNumWorkers, 1);
+		RunningWorks.Reset();
+	}
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	for (int32 Index = 0; Index < NumWorkers; ++Index)
+	{
+		TUniquePtr<FWorker>& Worker = Workers.Add_GetRef(MakeUnique<FWorker>(*this));
+		Threads.Add(FRunnableThread::Create(Worker.Get(), *FString::Printf(TEXT("GitSourceControlWorker%d"), Index), 0, TPri_BelowNormal));
+	}
+	UE_LOG(LogSourceControl, Log, TEXT("Started %d source control worker threads"), NumWorkers);
+}
+
+void FGitSourceControlScheduler::RequestStop()
+{
+	if (!IsStarted())
+	{
+		return;
+	}
+
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		bStopping = true;
+	}
+	// each worker thread wakes up the next one when stopping
+	WorkEvent->Trigger();
+}
+
+void FGitSourceControlScheduler::Stop()
+{
+	if (!IsStarted())
+	{
+		return;
+	}
+
+	RequestStop();
+	for (FRunnableThread* Thread : Threads)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+	}
+	Threads.Reset();
+	Workers.Reset();
+	NumWorkers = 0;
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+
+	TArray<FQueuedWork> AbandonedWorks;
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		for (TArray<FQueuedWork>& Queue : Queues)
+		{
+			AbandonedWorks.Append(MoveTemp(Queue));
+			Queue.Reset();
+		}
+	}
+	for (const FQueuedWork& QueuedWork : AbandonedWorks)
+	{
+		QueuedWork.Work->Abandon();
+	}
+}
+
+void FGitSourceControlScheduler::AddQueuedWork(IQueuedWork* InWork, const EGitCommandPriority::Type InPriority, FGitCommandScope&& InScope)
+{
+	check(IsStarted());
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		Queues[InPriority].Add({ InWork, NextSequence++, FPlatformTime::Seconds(), MoveTemp(InScope) });
+	}
+	WorkEvent->Trigger();
+}
+
+FGitSchedulerStats FGitSourceControlScheduler::GetStats() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	FGitSchedulerStats Stats;
+	Stats.NumWorkers = NumWorkers;
+	Stats.NumRunning = RunningWorks.Num();
+	for (uint32 Priority = 0; Priority < EGitCommandPriority::Count; ++Priority)
+	{
+		Stats.QueueDepth[Priority] = Queues[Priority].Num();
+		Stats.NumStarted[Priority] = NumStarted[Priority];
+		Stats.AverageWaitTime[Priority] = (NumStarted[Priority] > 0) ? (TotalWaitTime[Priority] / NumStarted[Priority]) : 0.0;
+		Stats.MaxWaitTime[Priority] = MaxWaitTime[Priority];
+	}
+	return Stats;
+}
+
+bool FGitSourceControlScheduler::IsBlocked(const FQueuedWork& InQueuedWork) const
+{
+	for (const FQueuedWork& RunningWork : RunningWorks)
+	{
+		if (InQueuedWork.Scope.Conflicts(RunningWork.Scope))
+		{
+			return true;
+		}
+	}
+	// never overtake a conflicting command queued before, whatever its priority class
+	for (const TArray<FQueuedWork>& Queue : Queues)
+	{
+		for (const FQueuedWork& QueuedWork : Queue)
+		{
+			if (QueuedWork.Sequence >= InQueuedWork.Sequence)
+			{
+				break;
+			}
+			if (InQueuedWork.Scope.Conflicts(QueuedWork.Scope))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+IQueuedWork* FGitSourceControlScheduler::DequeueWork(uint64& OutSequence)
+{
+	for (uint32 Priority = 0; Priority < EGitCommandPriority::Count; ++Priority)
+	{
+		// keep the last worker available for the interactive commands
+		if ((Priority != EGitCommandPriority::Interactive) && (NumWorkers > 1) && (RunningWorks.Num() >= NumWorkers - 1))
+		{
+			break;
+		}
+		TArray<FQueuedWork>& Queue = Queues[Priority];
+		for (int32 Index = 0; Index < Queue.Num(); ++Index)
+		{
+			if (IsBlocked(Queue[Index]))
+			{
+				continue;
+			}
+
+			const double WaitTime = FPlatformTime::Seconds() - Queue[Index].QueuedTime;
+			NumStarted[Priority]++;
+			TotalWaitTime[Priority] += WaitTime;
+			MaxWaitTime[Priority] = FMath::Max(MaxWaitTime[Priority], WaitTime);
+
+			IQueuedWork* Work = Queue[Index].Work;
+			OutSequence = Queue[Index].Sequence;
+			RunningWorks.Add(MoveTemp(Queue[Index]));
+			Queue.RemoveAt(Index, 1, false);
+			return Work;
+		}
+	}
+	return nullptr;
+}
+
+IQueuedWork* FGitSourceControlScheduler::WaitForWork(uint64& OutSequence)
+{
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&CriticalSection);
+			if (bStopping)
+			{
+				WorkEvent->Trigger();
+				return nullptr;
+			}
+			if (IQueuedWork* Work = DequeueWork(OutSequence))
+			{
+				// wake up another worker if there are more commands to start
+				for (const TArray<FQueuedWork>& Queue : Queues)
+				{
+					if (Queue.Num() > 0)
+					{
+						WorkEvent->Trigger();
+						break;
+					}
+				}
+				return Work;
+			}
+		}
+		WorkEvent->Wait();
+	}
+}
+
+void FGitSourceControlScheduler::OnWorkDone(const uint64 InSequence)
+{
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		RunningWorks.RemoveAll([InSequence](const FQueuedWork& InRunningWork) { return InRunningWork.Sequence == InSequence; });
+	}
+	// a worker is available again, maybe for a command of a lower priority class, or one that was waiting for this one
+	WorkEvent->Trigger();
+}
+
+uint32 FGitSourceControlScheduler::FWorker::Run()
+{
+	uint64 Sequence = 0;
+	while (IQueuedWork* Work = Scheduler.WaitForWork(Sequence))
+	{
+		Work->DoThreadedWork();
+		Scheduler.OnWorkDone(Sequence);
+	}
+	return 0;
+}
+
+FGitCommandScope::FGitCommandScope(const TArray<FString>& InFiles, const bool bInWrite)
+	: Files(InFiles)
+	, bWrite(bInWrite)
+{
+	for (FString& File : Files)
+	{
+		while (File.EndsWith(TEXT("/")))
+		{
+			File.LeftChopInline(1, false);
+		}
+	}
+	Files.Sort();
+}
+
+bool FGitCommandScope::Conflicts(const FGitCommandScope& InOther) const
+{
+	if (bWrite && InOther.bWrite)
+	{
+		return true;
+	}
+	// read-only commands can run in parallel even on the same files: the results of the older one never replace the ones of the newer one
+	if (!bWrite && !InOther.bWrite)
+	{
+		return false;
+	}
+	if ((Files.Num() == 0) || (InOther.Files.Num() == 0))
+	{
+		return true;
+	}
+	// look for the files of the smallest scope in the largest one
+	const FGitCommandScope& Smallest = (Files.Num() <= InOther.Files.Num()) ? *this : InOther;
+	const FGitCommandScope& Largest = (Files.Num() <= InOther.Files.Num()) ? InOther : *this;
+	for (const FString& File : Smallest.Files)
+	{
+		if (Largest.Overlaps(File))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FGitCommandScope::Overlaps(const FString& InPath) const
+{
+	// the path itself, or one of its parent directories
+	FString Path = InPath;
+	while (!Path.IsEmpty())
+	{
+		if (Algo::BinarySearch(Files, Path) != INDEX_NONE)
+		{
+			return true;
+		}
+		int32 SlashIndex;
+		if (!Path.FindLastChar(TEXT('/'), SlashIndex))
+		{
+			break;
+		}
+		Path.LeftInline(SlashIndex, false);
+	}
+	// or a file in the path, as a directory: the first one after "Path/" in the sorted files would start with it
+	const FString Directory = InPath + TEXT("/");
+	const int32 Index = Algo::LowerBound(Files, Directory);
+	return (Index < Files.Num()) && Files[Index].StartsWith(Directory);
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include "HAL/Event.h"
+
+class IQueuedWork;
+class FRunnableThread;
+
+/** Priority classes of the source control commands, from the highest to the lowest */
+namespace EGitCommandPriority
+{
+	enum Type : uint8
+	{
+		Interactive,	///< The user is waiting for it (synchronous commands, check-out on edit...)
+		Bulk,			///< Started by the user, but long (commit, sync, push...)
+		Background,		///< Status refreshes
+	};
+
+	static constexpr uint32 Count = 3;
+}
+
+/**
+ * Files (or directories) a command works on, and whether it writes to the repository, to order the commands that must not run concurrently
+ */
+struct FGitCommandScope
+{
+	/**
+	 * @param	InFiles		Absolute filenames or directories, or none for the whole repository
+	 * @param	bInWrite	Tells if the command writes to the repository (index, refs, working copy)
+	 */
+	FGitCommandScope(const TArray<FString>& InFiles, const bool bInWrite);
+
+	/**
+	 * Tells if two commands must run one after the other: both write to the repository (they would fight over .git/index.lock),
+	 * or one writes and their files overlap (same file, or a file in a directory of the other, or one is for the whole repository)
+	 */
+	bool Conflicts(const FGitCommandScope& InOther) const;
+
+	/** Sorted files, without any trailing slash */
+	TArray<FString> Files;
+	bool bWrite;
+
+private:
+	/** Tells if one of the files is, or is in, the given path, or contains it */
+	bool Overlaps(const FString& InPath) const;
+};
+
+/** Statistics of the scheduler, by priority class */
+struct FGitSchedulerStats
+{
+	int32 NumWorkers = 0;
+	int32 NumRunning = 0;
+	/** Number of commands waiting in the queue */
+	int32 QueueDepth[EGitCommandPriority::Count] = {};
+	/** Number of commands started since the scheduler started */
+	int32 NumStarted[EGitCommandPriority::Count] = {};
+	/** Average and maximum time spent by the started commands in the queue, in seconds */
+	double AverageWaitTime[EGitCommandPriority::Count] = {};
+	double MaxWaitTime[EGitCommandPriority::Count] = {};
+};
+
+/**
+ * Dedicated worker threads for the source control commands, owned by the provider,
+ * so that they do not compete with the other jobs of the engine thread pool (shader compilation, asset loading...).
+ *
+ * Commands are started by priority class, then in queue order, and the last worker is reserved for the interactive commands,
+ * so that a check-out never waits behind a long sync and a few status refreshes.
+ * But a command never starts while a conflicting one (see FGitCommandScope) is running or was queued before it:
+ * commands on the same files run in the order they were issued, and the ones writing to the repository one at a time,
+ * while the read-only ones run in parallel (the cache discards their stale results, see FGitSourceControlState::Generation).
+ */
+class FGitSourceControlScheduler
+{
+public:
+	~FGitSourceControlScheduler();
+
+	/** Start the worker threads (at least one) */
+	void Start(const int32 InNumWorkers);
+
+	/** Stop starting the queued commands, so that only the running ones remain for Stop() to wait for (see FGitSchedulerStats::NumRunning) */
+	void RequestStop();
+
+	/** Wait for the running commands to finish, stop the worker threads, and abandon the queued commands */
+	void Stop();
+
+	/** Tells if the worker threads are started */
+	bool IsStarted() const
+	{
+		return Threads.Num() > 0;
+	}
+
+	/** Queue a command, to be executed by one of the worker threads, after the ones queued before it that conflict with its scope */
+	void AddQueuedWork(IQueuedWork* InWork, const EGitCommandPriority::Type InPriority, FGitCommandScope&& InScope);
+
+	/** Get the current statistics */
+	FGitSchedulerStats GetStats() const;
+
+private:
+	/** Worker thread: executes the commands from the queues until the scheduler stops */
+	class FWorker : public FRunnable
+	{
+	public:
+		explicit FWorker(FGitSourceControlScheduler& InScheduler)
+			: Scheduler(InScheduler)
+		{
+		}
+
+		virtual uint32 Run() override;
+
+	private:
+		FGitSourceControlScheduler& Scheduler;
+	};
+
+	struct FQueuedWork
+	{
+		IQueuedWork* Work;
+		/** Order in which the commands were queued */
+		uint64 Sequence;
+		/** FPlatformTime::Seconds() when queued */
+		double QueuedTime;
+		FGitCommandScope Scope;
+	};
+
+	/** Wait for a command to execute, or return nullptr once stopping */
+	IQueuedWork* WaitForWork(uint64& OutSequence);
+
+	/** Called by a worker thread once a command is executed */
+	void OnWorkDone(const uint64 InSequence);
+
+	/** Take the next command that can start now, with the critical section held */
+	IQueuedWork* DequeueWork(uint64& OutSequence);
+
+	/** Tells if a queued command conflicts with a running one, or with one queued before it, with the critical section held */
+	bool IsBlocked(const FQueuedWork& InQueuedWork) const;
+
+	/** Critical section for thread safety of the queues and statistics */
+	mutable FCriticalSection CriticalSection;
+
+	/** Commands waiting to start, one queue per priority class */
+	TArray<FQueuedWork> Queues[EGitCommandPriority::Count];
+
+	/** Commands running (with their scope, to start the conflicting ones only after them) */
+	TArray<FQueuedWork> RunningWorks;
+
+	/** Sequence number of the next queued command */
+	uint64 NextSequence = 0;
+
+	/** Event signaled when a command can start (or when stopping), waking up one worker thread at a time */
+	FEvent* WorkEvent = nullptr;
+
+	TArray<TUniquePtr<FWorker>> Workers;
+	TArray<FRunnableThread*> Threads;
+
+	bool bStopping = false;
+	int32 NumWorkers = 0;
+
+	int32 NumStarted[EGitCommandPriority::Count] = {};
+	double TotalWaitTime[EGitCommandPriority::Count] = {};
+	double MaxWaitTime[EGitCommandPriority::Count] = {};
+};
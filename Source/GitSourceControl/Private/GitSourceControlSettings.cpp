@@ -87,6 +87,36 @@ bool FGitSourceControlSettings::IsPushAfterCommitEnabled() const
 	return bIsPushAfterCommitEnabled;
 }
 
+int32 FGitSourceControlSettings::GetLfsLocksCacheTTL() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return LfsLocksCacheTTL;
+}
+
+int32 FGitSourceControlSettings::GetNumWorkerThreads() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return NumWorkerThreads;
+}
+
+int32 FGitSourceControlSettings::GetLocalCommandTimeout() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return LocalCommandTimeout;
+}
+
+int32 FGitSourceControlSettings::GetLocalWriteCommandTimeout() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return LocalWriteCommandTimeout;
+}
+
+int32 FGitSourceControlSettings::GetNetworkCommandTimeout() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return NetworkCommandTimeout;
+}
+
 // This is called at startup nearly before anything else in our module: BinaryPath will then be used by the provider
 void FGitSourceControlSettings::LoadSettings()
 {
@@ -96,6 +126,11 @@ void FGitSourceControlSettings::LoadSettings()
 	GConfig->GetBool(*GitSettingsConstants::SettingsSection, TEXT("UsingGitLfsLocking"), bUsingGitLfsLocking, IniFile);
 	GConfig->GetString(*GitSettingsConstants::SettingsSection, TEXT("LfsUserName"), LfsUserName, IniFile);
 	GConfig->GetBool(*GitSettingsConstants::SettingsSection, TEXT("IsPushAfterCommitEnabled"), bIsPushAfterCommitEnabled, IniFile);
+	GConfig->GetInt(*GitSettingsConstants::SettingsSection, TEXT("LfsLocksCacheTTL"), LfsLocksCacheTTL, IniFile);
+	GConfig->GetInt(*GitSettingsConstants::SettingsSection, TEXT("NumWorkerThreads"), NumWorkerThreads, IniFile);
+	GConfig->GetInt(*GitSettingsConstants::SettingsSection, TEXT("LocalCommandTimeout"), LocalCommandTimeout, IniFile);
+	GConfig->GetInt(*GitSettingsConstants::SettingsSection, TEXT("LocalWriteCommandTimeout"), LocalWriteCommandTimeout, IniFile);
+	GConfig->GetInt(*GitSettingsConstants::SettingsSection, TEXT("NetworkCommandTimeout"), NetworkCommandTimeout, IniFile);
 }
 
 void FGitSourceControlSettings::SaveSettings() const
@@ -106,4 +141,9 @@ void FGitSourceControlSettings::SaveSettings() const
 	GConfig->SetBool(*GitSettingsConstants::SettingsSection, TEXT("UsingGitLfsLocking"), bUsingGitLfsLocking, IniFile);
 	GConfig->SetString(*GitSettingsConstants::SettingsSection, TEXT("LfsUserName"), *LfsUserName, IniFile);
 	GConfig->SetBool(*GitSettingsConstants::SettingsSection, TEXT("IsPushAfterCommitEnabled"), bIsPushAfterCommitEnabled, IniFile);
+	GConfig->SetInt(*GitSettingsConstants::SettingsSection, TEXT("LfsLocksCacheTTL"), LfsLocksCacheTTL, IniFile);
+	GConfig->SetInt(*GitSettingsConstants::SettingsSection, TEXT("NumWorkerThreads"), NumWorkerThreads, IniFile);
+	GConfig->SetInt(*GitSettingsConstants::SettingsSection, TEXT("LocalCommandTimeout"), LocalCommandTimeout, IniFile);
+	GConfig->SetInt(*GitSettingsConstants::SettingsSection, TEXT("LocalWriteCommandTimeout"), LocalWriteCommandTimeout, IniFile);
+	GConfig->SetInt(*GitSettingsConstants::SettingsSection, TEXT("NetworkCommandTimeout"), NetworkCommandTimeout, IniFile);
 }
@@ -34,6 +34,23 @@ public:
 	/** Get whether Submit means Commit AND push (default true) */
 	bool IsPushAfterCommitEnabled() const;
 
+	// The following advanced settings are only read from the ini file, when the editor starts
+
+	/** Get the time during which the Git LFS locks cached from the server are considered fresh, in seconds */
+	int32 GetLfsLocksCacheTTL() const;
+
+	/** Get the number of worker threads executing the source control commands */
+	int32 GetNumWorkerThreads() const;
+
+	/** Get the time without any output after which a local Git command is terminated, in seconds (0 for no timeout) */
+	int32 GetLocalCommandTimeout() const;
+
+	/** Get the time without any output after which a local Git command writing to the repository is terminated, in seconds (0 for no timeout) */
+	int32 GetLocalWriteCommandTimeout() const;
+
+	/** Get the time without any output after which a Git command contacting the remote is terminated, in seconds (0 for no timeout) */
+	int32 GetNetworkCommandTimeout() const;
+
 	/** Load settings from ini file */
 	void LoadSettings();
 
@@ -55,4 +72,19 @@ private:
 
 	/** Does Submit mean Commit AND push */
 	bool bIsPushAfterCommitEnabled = true;
+
+	/** Time during which the Git LFS locks cached from the server are considered fresh, in seconds */
+	int32 LfsLocksCacheTTL = 60;
+
+	/** Number of worker threads executing the source control commands */
+	int32 NumWorkerThreads = 4;
+
+	/** Time without any output after which a local Git command is terminated, in seconds (0 for no timeout) */
+	int32 LocalCommandTimeout = 300;
+
+	/** Time without any output after which a local Git command writing to the repository is terminated, in seconds (0 for no timeout) */
+	int32 LocalWriteCommandTimeout = 900;
+
+	/** Time without any output after which a Git command contacting the remote is terminated, in seconds (0 for no timeout) */
+	int32 NetworkCommandTimeout = 600;
 };
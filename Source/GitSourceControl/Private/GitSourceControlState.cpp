@@ -211,7 +211,7 @@ FText FGitSourceControlState::GetDisplayName() const
 	}
 	else if (LockState == ELockState::LockedOther)
 	{
-		return FText::Format(LOCTEXT("LockedOther", "Locked by "), FText::FromString(LockUser));
+		return FText::Format(LOCTEXT("LockedOther", "Locked by "), FText::FromName(LockUser));
 	}
 	else if (!IsCurrent())
 	{
@@ -255,7 +255,7 @@ FText FGitSourceControlState::GetDisplayTooltip() const
 	}
 	else if (LockState == ELockState::LockedOther)
 	{
-		return FText::Format(LOCTEXT("LockedOther_Tooltip", "Locked for editing by: {0}"), FText::FromString(LockUser));
+		return FText::Format(LOCTEXT("LockedOther_Tooltip", "Locked for editing by: {0}"), FText::FromName(LockUser));
 	}
 	else if (!IsCurrent())
 	{
@@ -347,7 +347,7 @@ bool FGitSourceControlState::IsCheckedOutOther(FString* Who) const
 {
 	if (Who != NULL)
 	{
-		*Who = LockUser;
+		*Who = LockUser.IsNone() ? FString() : LockUser.ToString();
 	}
 	return LockState == ELockState::LockedOther;
 }
@@ -47,11 +47,12 @@ class FGitSourceControlState : public ISourceControlState
 public:
 	FGitSourceControlState(const FString& InLocalFilename, const bool InUsingLfsLocking)
 		: LocalFilename(InLocalFilename)
+		  , TimeStamp(0)
+		  , Generation(0)
 		  , WorkingCopyState(EWorkingCopyState::Unknown)
 		  , LockState(ELockState::Unknown)
 		  , bUsingGitLfsLocking(InUsingLfsLocking)
 		  , bNewerVersionOnServer(false)
-		  , TimeStamp(0)
 	{
 	}
 
@@ -114,21 +115,24 @@ public:
 	FString PendingMergeBaseFileHash;
 #endif
 
-	/** State of the working copy */
-	EWorkingCopyState::Type WorkingCopyState;
+	/** The timestamp of the last update */
+	FDateTime TimeStamp;
+
+	/** Name of user who has locked the file (interned, since a few users lock many files) */
+	FName LockUser;
 
-	/** Lock state */
-	ELockState::Type LockState;
+	/** Generation of the command that produced this state, so that the results of an older command never replace it (see FGitSourceControlStateCache::Update()) */
+	uint32 Generation;
 
-	/** Name of user who has locked the file */
-	FString LockUser;
+	/** State of the working copy (packed with the other small members, there is one state per file of the project) */
+	TEnumAsByte<EWorkingCopyState::Type> WorkingCopyState;
+
+	/** Lock state */
+	TEnumAsByte<ELockState::Type> LockState;
 
 	/** Tells if using the Git LFS file Locking workflow */
-	bool bUsingGitLfsLocking;
+	uint8 bUsingGitLfsLocking : 1;
 
 	/** Whether a newer version exists on the server */
-	bool bNewerVersionOnServer;
-
-	/** The timestamp of the last update */
-	FDateTime TimeStamp;
+	uint8 bNewerVersionOnServer : 1;
 };
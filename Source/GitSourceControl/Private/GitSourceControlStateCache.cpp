@@ -0,0 +1,335 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#include "GitSourceControlStateCache.h"
+
+#include "Misc/ScopeRWLock.h"
+#include "ISourceControlModule.h"
+
+FGitSourceControlStateRef FGitSourceControlStateCache::FindOrAdd(const FString& InFilename, const bool bInUsingLfsLocking)
+{
+	FShard& Shard = GetShard(InFilename);
+	{
+		FReadScopeLock ReadLock(Shard.Lock);
+		if(const FGitSourceControlStateRef* State = Shard.States.Find(InFilename))
+		{
+			return *State;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Shard.Lock);
+	// The state could have been added by another thread meanwhile
+	if(const FGitSourceControlStateRef* State = Shard.States.Find(InFilename))
+	{
+		return *State;
+	}
+	FGitSourceControlStateRef NewState = MakeShared<FGitSourceControlState, ESPMode::ThreadSafe>(InFilename, bInUsingLfsLocking);
+	Shard.States.Add(NewState);
+	AddIndices(InFilename, GetIndices(*NewState));
+	return NewState;
+}
+
+FGitSourceControlStatePtr FGitSourceControlStateCache::Find(const FString& InFilename) const
+{
+	const FShard& Shard = GetShard(InFilename);
+	FReadScopeLock ReadLock(Shard.Lock);
+	if(const FGitSourceControlStateRef* State = Shard.States.Find(InFilename))
+	{
+		return *State;
+	}
+	return nullptr;
+}
+
+void FGitSourceControlStateCache::Add(const FGitSourceControlStateRef& InState)
+{
+	FShard& Shard = GetShard(InState->LocalFilename);
+	FWriteScopeLock WriteLock(Shard.Lock);
+	if(const FGitSourceControlStateRef* OldState = Shard.States.Find(InState->LocalFilename))
+	{
+		const uint32 OldIndices = GetIndices(**OldState);
+		Shard.States.Add(InState);
+		UpdateIndices(InState->LocalFilename, OldIndices, GetIndices(*InState));
+	}
+	else
+	{
+		Shard.States.Add(InState);
+		AddIndices(InState->LocalFilename, GetIndices(*InState));
+	}
+}
+
+bool FGitSourceControlStateCache::Update(FGitSourceControlState&& InState, const FDateTime& InTimeStamp)
+{
+	// Prepare the new state before taking the lock
+	FGitSourceControlStateRef NewState = MakeShared<FGitSourceControlState, ESPMode::ThreadSafe>(MoveTemp(InState));
+	NewState->TimeStamp = InTimeStamp;
+	const uint32 NewIndices = GetIndices(*NewState);
+
+	FShard& Shard = GetShard(NewState->LocalFilename);
+	FWriteScopeLock WriteLock(Shard.Lock);
+	if(const FGitSourceControlStateRef* OldState = Shard.States.Find(NewState->LocalFilename))
+	{
+		if((*OldState)->Generation > NewState->Generation)
+		{
+			UE_LOG(LogSourceControl, Verbose, TEXT("Discarded a stale state of '%s' (generation %u < %u)"), *NewState->LocalFilename, NewState->Generation, (*OldState)->Generation);
+			return false;
+		}
+		const bool bChanged = !IsSameDisplayedState(**OldState, *NewState);
+		const uint32 OldIndices = GetIndices(**OldState);
+		Shard.States.Add(NewState);
+		UpdateIndices(NewState->LocalFilename, OldIndices, NewIndices);
+		return bChanged;
+	}
+	else
+	{
+		Shard.States.Add(NewState);
+		AddIndices(NewState->LocalFilename, NewIndices);
+		return true;
+	}
+}
+
+bool FGitSourceControlStateCache::Remove(const FString& InFilename)
+{
+	FShard& Shard = GetShard(InFilename);
+	FWriteScopeLock WriteLock(Shard.Lock);
+	const FGitSourceControlStateRef* OldState = Shard.States.Find(InFilename);
+	if(!OldState)
+	{
+		return false;
+	}
+	RemoveIndices((*OldState)->LocalFilename, GetIndices(**OldState));
+	Shard.States.Remove(InFilename);
+	return true;
+}
+
+void FGitSourceControlStateCache::Empty()
+{
+	for(FShard& Shard : Shards)
+	{
+		FWriteScopeLock WriteLock(Shard.Lock);
+		Shard.States.Empty();
+	}
+	FWriteScopeLock WriteLock(IndicesLock);
+	for(TSet<FString>& Index : Indices)
+	{
+		Index.Empty();
+	}
+	DirectoryTree.Empty();
+}
+
+int32 FGitSourceControlStateCache::Num() const
+{
+	int32 Num = 0;
+	for(const FShard& Shard : Shards)
+	{
+		FReadScopeLock ReadLock(Shard.Lock);
+		Num += Shard.States.Num();
+	}
+	return Num;
+}
+
+TArray<FGitSourceControlStateRef> FGitSourceControlStateCache::GetStates() const
+{
+	TArray<FGitSourceControlStateRef> States;
+	for(const FShard& Shard : Shards)
+	{
+		FReadScopeLock ReadLock(Shard.Lock);
+		States.Reserve(States.Num() + Shard.States.Num());
+		for(const FGitSourceControlStateRef& State : Shard.States)
+		{
+			States.Add(State);
+		}
+	}
+	return States;
+}
+
+TArray<FString> FGitSourceControlStateCache::GetFilenames() const
+{
+	TArray<FString> Filenames;
+	for(const FShard& Shard : Shards)
+	{
+		FReadScopeLock ReadLock(Shard.Lock);
+		Filenames.Reserve(Filenames.Num() + Shard.States.Num());
+		for(const FGitSourceControlStateRef& State : Shard.States)
+		{
+			Filenames.Add(State->LocalFilename);
+		}
+	}
+	return Filenames;
+}
+
+TArray<FString> FGitSourceControlStateCache::GetFilenames(const uint32 InIndices) const
+{
+	FReadScopeLock ReadLock(IndicesLock);
+	TArray<FString> Filenames;
+	if(FMath::CountBits(InIndices) == 1)
+	{
+		Filenames = Indices[FMath::FloorLog2(InIndices)].Array();
+	}
+	else
+	{
+		// A file can be in more than one category
+		TSet<FString> UniqueFilenames;
+		for(uint32 Index = 0; Index < EGitStateIndex::Count; ++Index)
+		{
+			if(InIndices & (1 << Index))
+			{
+				UniqueFilenames.Append(Indices[Index]);
+			}
+		}
+		Filenames = UniqueFilenames.Array();
+	}
+	return Filenames;
+}
+
+TArray<FGitSourceControlStateRef> FGitSourceControlStateCache::GetStates(const uint32 InIndices) const
+{
+	// Never hold the lock of the indices while taking the one of a shard
+	const TArray<FString> Filenames = GetFilenames(InIndices);
+	TArray<FGitSourceControlStateRef> States;
+	States.Reserve(Filenames.Num());
+	for(const FString& Filename : Filenames)
+	{
+		if(FGitSourceControlStatePtr State = Find(Filename))
+		{
+			States.Add(State.ToSharedRef());
+		}
+	}
+	return States;
+}
+
+TArray<FString> FGitSourceControlStateCache::GetFilenamesInDirectory(const FString& InDirectory, const uint32 InIndices) const
+{
+	FReadScopeLock ReadLock(IndicesLock);
+	TArray<FString> Filenames;
+	DirectoryTree.GetFilenames(InDirectory, InIndices, Filenames);
+	return Filenames;
+}
+
+TArray<FGitSourceControlStateRef> FGitSourceControlStateCache::GetStatesInDirectory(const FString& InDirectory, const uint32 InIndices) const
+{
+	// Never hold the lock of the indices while taking the one of a shard
+	const TArray<FString> Filenames = GetFilenamesInDirectory(InDirectory, InIndices);
+	TArray<FGitSourceControlStateRef> States;
+	States.Reserve(Filenames.Num());
+	for(const FString& Filename : Filenames)
+	{
+		if(FGitSourceControlStatePtr State = Find(Filename))
+		{
+			States.Add(State.ToSharedRef());
+		}
+	}
+	return States;
+}
+
+FGitDirectoryStateCounts FGitSourceControlStateCache::GetDirectoryStateCounts(const FString& InDirectory) const
+{
+	FReadScopeLock ReadLock(IndicesLock);
+	return DirectoryTree.GetCounts(InDirectory);
+}
+
+bool FGitSourceControlStateCache::IsSameDisplayedState(const FGitSourceControlState& InA, const FGitSourceControlState& InB)
+{
+	return (InA.WorkingCopyState == InB.WorkingCopyState)
+		&& (InA.LockState == InB.LockState)
+		&& (InA.LockUser == InB.LockUser)
+		&& (InA.bNewerVersionOnServer == InB.bNewerVersionOnServer)
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3
+		&& (InA.PendingResolveInfo.BaseRevision == InB.PendingResolveInfo.BaseRevision)
+		&& (InA.PendingResolveInfo.RemoteRevision == InB.PendingResolveInfo.RemoteRevision);
+#else
+		&& (InA.PendingMergeBaseFileHash == InB.PendingMergeBaseFileHash);
+#endif
+}
+
+uint32 FGitSourceControlStateCache::GetIndices(const FGitSourceControlState& InState)
+{
+	uint32 StateIndices = EGitStateIndex::None;
+	if(InState.IsModified())
+	{
+		StateIndices |= EGitStateIndex::Modified;
+	}
+	if(InState.IsAdded())
+	{
+		StateIndices |= EGitStateIndex::Added;
+	}
+	if(InState.IsDeleted())
+	{
+		StateIndices |= EGitStateIndex::Deleted;
+	}
+	if(InState.IsConflicted())
+	{
+		StateIndices |= EGitStateIndex::Conflicted;
+	}
+	if(InState.LockState == ELockState::Locked)
+	{
+		StateIndices |= EGitStateIndex::LockedByMe;
+	}
+	else if(InState.LockState == ELockState::LockedOther)
+	{
+		StateIndices |= EGitStateIndex::LockedByOther;
+	}
+	if(InState.bNewerVersionOnServer)
+	{
+		StateIndices |= EGitStateIndex::NewerOnServer;
+	}
+	if(InState.WorkingCopyState == EWorkingCopyState::NotControlled)
+	{
+		StateIndices |= EGitStateIndex::NotControlled;
+	}
+	return StateIndices;
+}
+
+void FGitSourceControlStateCache::UpdateIndices(const FString& InFilename, const uint32 InOldIndices, const uint32 InNewIndices)
+{
+	const uint32 ChangedIndices = InOldIndices ^ InNewIndices;
+	if(ChangedIndices == EGitStateIndex::None)
+	{
+		return;
+	}
+
+	FWriteScopeLock WriteLock(IndicesLock);
+	for(uint32 Index = 0; Index < EGitStateIndex::Count; ++Index)
+	{
+		const uint32 Flag = 1 << Index;
+		if(ChangedIndices & Flag)
+		{
+			if(InNewIndices & Flag)
+			{
+				Indices[Index].Add(InFilename);
+			}
+			else
+			{
+				Indices[Index].Remove(InFilename);
+			}
+		}
+	}
+	DirectoryTree.Add(InFilename, InNewIndices);
+}
+
+void FGitSourceControlStateCache::AddIndices(const FString& InFilename, const uint32 InIndices)
+{
+	FWriteScopeLock WriteLock(IndicesLock);
+	for(uint32 Index = 0; Index < EGitStateIndex::Count; ++Index)
+	{
+		if(InIndices & (1 << Index))
+		{
+			Indices[Index].Add(InFilename);
+		}
+	}
+	DirectoryTree.Add(InFilename, InIndices);
+}
+
+void FGitSourceControlStateCache::RemoveIndices(const FString& InFilename, const uint32 InIndices)
+{
+	FWriteScopeLock WriteLock(IndicesLock);
+	for(uint32 Index = 0; Index < EGitStateIndex::Count; ++Index)
+	{
+		if(InIndices & (1 << Index))
+		{
+			Indices[Index].Remove(InFilename);
+		}
+	}
+	DirectoryTree.Remove(InFilename);
+}
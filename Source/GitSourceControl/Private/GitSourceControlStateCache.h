@@ -0,0 +1,154 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "GitSourceControlState.h"
+#include "GitSourceControlStateTree.h"
+
+typedef TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe> FGitSourceControlStateRef;
+typedef TSharedPtr<FGitSourceControlState, ESPMode::ThreadSafe> FGitSourceControlStatePtr;
+
+/**
+ * Cache of the states of files, by absolute filename, owned by the provider.
+ *
+ * Sharded by hash of the filename, each shard with its own reader/writer lock,
+ * so that worker threads can query the cache while the game thread updates it.
+ * NOTE: only the map itself is protected: states are only updated by the game thread (see UpdateCachedStates()), by replacing them
+ * NOTE: the LocalFilename of a cached state is its key, so it must never change
+ *
+ * Also maintains secondary indices of the filenames by category (modified, locked...), updated along with the states,
+ * so that a query of a category takes a time proportional to its number of files,
+ * and a tree of their directories, so that a query of a directory (of a category or not) does not scan the whole cache either.
+ */
+class FGitSourceControlStateCache
+{
+public:
+	/**
+	 * Find the state of a file, or add an unknown state for it
+	 *
+	 * @param	InFilename			Absolute filename
+	 * @param	bInUsingLfsLocking	Tells if using the Git LFS file Locking workflow, for a new state
+	 */
+	FGitSourceControlStateRef FindOrAdd(const FString& InFilename, const bool bInUsingLfsLocking);
+
+	/** Find the state of a file, if in the cache */
+	FGitSourceControlStatePtr Find(const FString& InFilename) const;
+
+	/** Add (or replace) the state of a file, by its LocalFilename */
+	void Add(const FGitSourceControlStateRef& InState);
+
+	/**
+	 * Update the state of a file (adding it if needed), and the indices accordingly
+	 *
+	 * The cached state is replaced by a new one as a whole, so that readers holding the previous one never see a partially updated state.
+	 * A state older than the cached one (of a lower Generation, from a command issued before the one of the cached state) is discarded.
+	 *
+	 * @param	InState				New state of the file, moved into the cache
+	 * @param	InTimeStamp			Time of the update
+	 * @returns true if the displayed state of the file changed (status, lock, newer version or conflict), false if it came back identical or was discarded
+	 */
+	bool Update(FGitSourceControlState&& InState, const FDateTime& InTimeStamp);
+
+	/** Remove the state of a file, returning true if it was in the cache */
+	bool Remove(const FString& InFilename);
+
+	/** Remove all states */
+	void Empty();
+
+	/** Number of states in the cache */
+	int32 Num() const;
+
+	/** Get all the states in the cache (a copy, so that they can be used without holding any lock) */
+	TArray<FGitSourceControlStateRef> GetStates() const;
+
+	/** Get the filenames of all the states in the cache */
+	TArray<FString> GetFilenames() const;
+
+	/** Get the filenames of the states in any of the given categories (a combination of EGitStateIndex flags) */
+	TArray<FString> GetFilenames(const uint32 InIndices) const;
+
+	/** Get the states in any of the given categories (a combination of EGitStateIndex flags) */
+	TArray<FGitSourceControlStateRef> GetStates(const uint32 InIndices) const;
+
+	/**
+	 * Get the filenames of the states in a directory and its subdirectories
+	 *
+	 * @param	InDirectory		Absolute path of the directory
+	 * @param	InIndices		Only the states in any of these categories (a combination of EGitStateIndex flags), or all of them if None
+	 */
+	TArray<FString> GetFilenamesInDirectory(const FString& InDirectory, const uint32 InIndices = EGitStateIndex::None) const;
+
+	/** Get the states in a directory and its subdirectories, optionally only the ones in any of the given categories */
+	TArray<FGitSourceControlStateRef> GetStatesInDirectory(const FString& InDirectory, const uint32 InIndices = EGitStateIndex::None) const;
+
+	/** Get the counts of states in a directory and its subdirectories, by category */
+	FGitDirectoryStateCounts GetDirectoryStateCounts(const FString& InDirectory) const;
+
+private:
+	/** Number of shards: a power of two, enough for a few worker threads and the game thread to rarely contend */
+	static constexpr uint32 NumShards = 16;
+
+	/** States are keyed by their own LocalFilename, instead of a copy of it in a map */
+	struct FStateKeyFuncs : BaseKeyFuncs<FGitSourceControlStateRef, FString, false>
+	{
+		static const FString& GetSetKey(const FGitSourceControlStateRef& InState)
+		{
+			return InState->LocalFilename;
+		}
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A == B;
+		}
+		static uint32 GetKeyHash(const FString& InKey)
+		{
+			return GetTypeHash(InKey);
+		}
+	};
+
+	struct FShard
+	{
+		mutable FRWLock Lock;
+		TSet<FGitSourceControlStateRef, FStateKeyFuncs> States;
+	};
+
+	/** Shard of a filename (FString hashes are case-insensitive, like the keys of the maps) */
+	FShard& GetShard(const FString& InFilename)
+	{
+		return Shards[GetTypeHash(InFilename) & (NumShards - 1)];
+	}
+	const FShard& GetShard(const FString& InFilename) const
+	{
+		return Shards[GetTypeHash(InFilename) & (NumShards - 1)];
+	}
+
+	/** Tells if two states of a file are displayed the same (icons and tooltips), regardless of their timestamp and history */
+	static bool IsSameDisplayedState(const FGitSourceControlState& InA, const FGitSourceControlState& InB);
+
+	/** Categories of a state (a combination of EGitStateIndex flags) */
+	static uint32 GetIndices(const FGitSourceControlState& InState);
+
+	/** Move a filename from its previous categories to its new ones, with the lock of its shard held */
+	void UpdateIndices(const FString& InFilename, const uint32 InOldIndices, const uint32 InNewIndices);
+
+	/** Index a new filename, with the lock of its shard held */
+	void AddIndices(const FString& InFilename, const uint32 InIndices);
+
+	/** Remove a filename from the indices, with the lock of its shard held */
+	void RemoveIndices(const FString& InFilename, const uint32 InIndices);
+
+	FShard Shards[NumShards];
+
+	/** Lock of the indices and of the tree, always taken after the one of a shard (never the other way around) */
+	mutable FRWLock IndicesLock;
+
+	/** Filenames of the states of each category, one set per EGitStateIndex flag */
+	TSet<FString> Indices[EGitStateIndex::Count];
+
+	/** Directories of the filenames of all the states, with their categories */
+	FGitStateDirectoryTree DirectoryTree;
+};
@@ -0,0 +1,180 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#include "GitSourceControlStateTree.h"
+
+void FGitStateDirectoryTree::SplitPath(const FString& InPath, TArray<FString>& OutNames)
+{
+	InPath.ParseIntoArray(OutNames, TEXT("/"), true);
+}
+
+void FGitStateDirectoryTree::UpdateCounts(FGitDirectoryStateCounts& InOutCounts, const uint32 InIndices, const int32 InSign)
+{
+	InOutCounts.NumFiles += InSign;
+	for(uint32 Index = 0; Index < EGitStateIndex::Count; ++Index)
+	{
+		if(InIndices & (1 << Index))
+		{
+			InOutCounts.Counts[Index] += InSign;
+		}
+	}
+}
+
+void FGitStateDirectoryTree::Add(const FString& InFilename, const uint32 InIndices)
+{
+	TArray<FString> Names;
+	SplitPath(InFilename, Names);
+	if(Names.Num() == 0)
+	{
+		return;
+	}
+
+	// Create the missing directories on the way
+	TArray<FNode*, TInlineAllocator<32>> Path;
+	Path.Add(&Root);
+	for(int32 Index = 0; Index < Names.Num() - 1; ++Index)
+	{
+		TUniquePtr<FNode>& Child = Path.Last()->Directories.FindOrAdd(Names[Index]);
+		if(!Child.IsValid())
+		{
+			Child = MakeUnique<FNode>();
+		}
+		Path.Add(Child.Get());
+	}
+
+	if(uint32* OldIndices = Path.Last()->Files.Find(Names.Last()))
+	{
+		const uint32 PreviousIndices = *OldIndices;
+		*OldIndices = InIndices;
+		for(FNode* Node : Path)
+		{
+			UpdateCounts(Node->Counts, PreviousIndices, -1);
+			UpdateCounts(Node->Counts, InIndices, +1);
+		}
+	}
+	else
+	{
+		Path.Last()->Files.Add(Names.Last(), InIndices);
+		for(FNode* Node : Path)
+		{
+			UpdateCounts(Node->Counts, InIndices, +1);
+		}
+	}
+}
+
+void FGitStateDirectoryTree::Remove(const FString& InFilename)
+{
+	TArray<FString> Names;
+	SplitPath(InFilename, Names);
+	if(Names.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FNode*, TInlineAllocator<32>> Path;
+	Path.Add(&Root);
+	for(int32 Index = 0; Index < Names.Num() - 1; ++Index)
+	{
+		const TUniquePtr<FNode>* Child = Path.Last()->Directories.Find(Names[Index]);
+		if(!Child)
+		{
+			return;
+		}
+		Path.Add(Child->Get());
+	}
+
+	uint32 OldIndices;
+	if(!Path.Last()->Files.RemoveAndCopyValue(Names.Last(), OldIndices))
+	{
+		return;
+	}
+	for(FNode* Node : Path)
+	{
+		UpdateCounts(Node->Counts, OldIndices, -1);
+	}
+
+	// Remove the directories left empty, from the deepest one
+	for(int32 Index = Path.Num() - 1; Index > 0; --Index)
+	{
+		if(Path[Index]->Counts.NumFiles > 0)
+		{
+			break;
+		}
+		Path[Index - 1]->Directories.Remove(Names[Index - 1]);
+	}
+}
+
+void FGitStateDirectoryTree::Empty()
+{
+	Root = FNode();
+}
+
+const FGitStateDirectoryTree::FNode* FGitStateDirectoryTree::FindNode(const FString& InDirectory) const
+{
+	TArray<FString> Names;
+	SplitPath(InDirectory, Names);
+	const FNode* Node = &Root;
+	for(const FString& Name : Names)
+	{
+		const TUniquePtr<FNode>* Child = Node->Directories.Find(Name);
+		if(!Child)
+		{
+			return nullptr;
+		}
+		Node = Child->Get();
+	}
+	return Node;
+}
+
+void FGitStateDirectoryTree::CollectFilenames(const FNode& InNode, const FString& InPath, const uint32 InIndices, TArray<FString>& OutFilenames)
+{
+	for(const auto& File : InNode.Files)
+	{
+		if((InIndices == EGitStateIndex::None) || (File.Value & InIndices))
+		{
+			OutFilenames.Add(InPath / File.Key);
+		}
+	}
+	for(const auto& Directory : InNode.Directories)
+	{
+		const FNode& Child = *Directory.Value;
+		if(InIndices != EGitStateIndex::None)
+		{
+			// Skip the subtrees without any file of these categories
+			bool bHasMatchingFiles = false;
+			for(uint32 Index = 0; (Index < EGitStateIndex::Count) && !bHasMatchingFiles; ++Index)
+			{
+				bHasMatchingFiles = (InIndices & (1 << Index)) && (Child.Counts.Counts[Index] > 0);
+			}
+			if(!bHasMatchingFiles)
+			{
+				continue;
+			}
+		}
+		CollectFilenames(Child, InPath / Directory.Key, InIndices, OutFilenames);
+	}
+}
+
+void FGitStateDirectoryTree::GetFilenames(const FString& InDirectory, const uint32 InIndices, TArray<FString>& OutFilenames) const
+{
+	if(const FNode* Node = FindNode(InDirectory))
+	{
+		FString Path = InDirectory;
+		while(Path.EndsWith(TEXT("/")))
+		{
+			Path.LeftChopInline(1, false);
+		}
+		CollectFilenames(*Node, Path, InIndices, OutFilenames);
+	}
+}
+
+FGitDirectoryStateCounts FGitStateDirectoryTree::GetCounts(const FString& InDirectory) const
+{
+	if(const FNode* Node = FindNode(InDirectory))
+	{
+		return Node->Counts;
+	}
+	return FGitDirectoryStateCounts();
+}
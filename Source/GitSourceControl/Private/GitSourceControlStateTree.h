@@ -0,0 +1,99 @@
+// Copyright (c) 2014-2022 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+//
+// Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+// or copy at http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+/** Secondary indices of the state cache, to query the states of a category without scanning the whole cache */
+namespace EGitStateIndex
+{
+	enum Type : uint32
+	{
+		None			= 0,
+		Modified		= 1 << 0,	///< IsModified(): added, deleted, modified, renamed, copied, missing or conflicted
+		Added			= 1 << 1,
+		Deleted			= 1 << 2,	///< deleted or missing
+		Conflicted		= 1 << 3,
+		LockedByMe		= 1 << 4,
+		LockedByOther	= 1 << 5,
+		NewerOnServer	= 1 << 6,
+		NotControlled	= 1 << 7,
+	};
+
+	static constexpr uint32 Count = 8;
+}
+
+/** Number of cached files in a directory and its subdirectories, in total and by category */
+struct FGitDirectoryStateCounts
+{
+	int32 NumFiles = 0;
+	int32 Counts[EGitStateIndex::Count] = {};
+
+	/** Number of files of a category (a single EGitStateIndex flag) */
+	int32 Get(const EGitStateIndex::Type InIndex) const
+	{
+		return Counts[FMath::FloorLog2(InIndex)];
+	}
+};
+
+/**
+ * Tree of the directories of the cached files, with the categories of each file (EGitStateIndex flags)
+ * and the counts of files by category aggregated for each directory.
+ *
+ * Enumerating the files of a directory takes a time proportional to its subtree, and even to the number of matching files
+ * when filtering by categories, since subtrees without any file of these categories are skipped.
+ * NOTE: not thread-safe, see FGitSourceControlStateCache
+ */
+class FGitStateDirectoryTree
+{
+public:
+	/** Add a file with its categories, or update its categories if already there */
+	void Add(const FString& InFilename, const uint32 InIndices);
+
+	/** Remove a file, and the directories left empty */
+	void Remove(const FString& InFilename);
+
+	/** Remove all files */
+	void Empty();
+
+	/**
+	 * Get the files in a directory and its subdirectories
+	 *
+	 * @param	InDirectory		Absolute path of the directory (with or without a trailing slash)
+	 * @param	InIndices		Only the files in any of these categories (a combination of EGitStateIndex flags), or all the files if None
+	 * @param	OutFilenames	Absolute filenames
+	 */
+	void GetFilenames(const FString& InDirectory, const uint32 InIndices, TArray<FString>& OutFilenames) const;
+
+	/** Get the counts of files in a directory and its subdirectories */
+	FGitDirectoryStateCounts GetCounts(const FString& InDirectory) const;
+
+private:
+	struct FNode
+	{
+		/** Subdirectories, by name */
+		TMap<FString, TUniquePtr<FNode>> Directories;
+		/** Files directly in this directory, by name, with their categories */
+		TMap<FString, uint32> Files;
+		/** Counts of files in this directory and its subdirectories */
+		FGitDirectoryStateCounts Counts;
+	};
+
+	/** Split a path into the names of its directories and file */
+	static void SplitPath(const FString& InPath, TArray<FString>& OutNames);
+
+	/** Add (or remove, with a negative sign) a file of these categories to the counts */
+	static void UpdateCounts(FGitDirectoryStateCounts& InOutCounts, const uint32 InIndices, const int32 InSign);
+
+	/** Find the node of a directory, if any */
+	const FNode* FindNode(const FString& InDirectory) const;
+
+	/** Add the files of a node and its subnodes, given the path of the node */
+	static void CollectFilenames(const FNode& InNode, const FString& InPath, const uint32 InIndices, TArray<FString>& OutFilenames);
+
+	FNode Root;
+};
@@ -7,6 +7,7 @@
 
 #include "GitSourceControlCommand.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
 #if ENGINE_MAJOR_VERSION >= 5
 #include "HAL/PlatformFileManager.h" 
 #else
@@ -23,12 +24,28 @@
 #if PLATFORM_LINUX
 #include <sys/ioctl.h>
 #endif
+#if PLATFORM_LINUX || PLATFORM_MAC
+#include <unistd.h>
+#endif
+
+// CreateProc() can redirect the standard error of the child process to its own pipe only since UE5.1
+#define GIT_PROCESS_WITH_STDERR_PIPE (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1)
 
 
 namespace GitSourceControlConstants
 {
-	/** The maximum number of files we submit in a single Git command */
-	const int32 MaxFilesPerBatch = 50;
+#if PLATFORM_WINDOWS
+	/** The maximum length of a command line, in characters (CreateProcess() limit) */
+	const int32 MaxCommandLineLength = 32767;
+#else
+	/** The maximum number of arguments on a command line (CreateProc() limit of Unix platforms, PlatformProcessLimits::MaxArgvParameters) */
+	const int32 MaxCommandLineArguments = 256;
+#endif
+	/** Room left on the command line for what is not known when splitting files into batches */
+	const int32 CommandLineMargin = 256;
+
+	/** Minimum time between two fetches from the remote server, in seconds */
+	const double MinFetchInterval = 60.0;
 }
 
 FGitScopedTempFile::FGitScopedTempFile(const FText& InText)
@@ -56,113 +73,773 @@ const FString& FGitScopedTempFile::GetFilename() const
 	return Filename;
 }
 
+/**
+ * Build the executable and the parameters to launch Git in the given repository
+ *
+ * @param	InPathToGitBinary	The path to the Git binary
+ * @param	InRepositoryRoot	The Git repository from where to run the command (can be empty)
+ * @param	InCommandLine		The Git command followed by its parameters
+ * @param	OutExecutable		The executable to launch (the Git binary, or env under Mac)
+ * @param	OutParameters		The full command line to give to the executable
+ */
+static void GetGitCommandLine(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InCommandLine, FString& OutExecutable, FString& OutParameters)
+{
+	OutParameters.Reset();
+	if(!InRepositoryRoot.IsEmpty())
+	{
+		// Specify the working copy (the root) of the git repository (before the command itself)
+		OutParameters  = TEXT("-C \"");
+		OutParameters += InRepositoryRoot;
+		OutParameters += TEXT("\" ");
+	}
+	// Don't let "git status" and other read-only commands take ".git/index.lock" to refresh the index as an optimization:
+	// the scheduler runs them in parallel with the commands writing to the repository, which would then fail to take the lock.
+	// The commands writing to the repository still take it, since it is not optional for them.
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	if(GitSourceControl.GetProvider().GetGitVersion().bHasNoOptionalLocks)
+	{
+		OutParameters += TEXT("--no-optional-locks ");
+	}
+	OutParameters += InCommandLine;
+
+	OutExecutable = InPathToGitBinary;
+#if PLATFORM_MAC
+	// The Cocoa application does not inherit shell environment variables, so add the path expected to have git-lfs to PATH
+	FString PathEnv = FPlatformMisc::GetEnvironmentVariable(TEXT("PATH"));
+	FString GitInstallPath = FPaths::GetPath(InPathToGitBinary);
+
+	TArray<FString> PathArray;
+	PathEnv.ParseIntoArray(PathArray, FPlatformMisc::GetPathVarDelimiter());
+	bool bHasGitInstallPath = false;
+	for (auto Path : PathArray)
+	{
+		if (GitInstallPath.Equals(Path, ESearchCase::CaseSensitive))
+		{
+			bHasGitInstallPath = true;
+			break;
+		}
+	}
+
+	if (!bHasGitInstallPath)
+	{
+		OutExecutable = FString("/usr/bin/env");
+		OutParameters = FString::Printf(TEXT("PATH=\"%s%s%s\" \"%s\" %s"), *GitInstallPath, FPlatformMisc::GetPathVarDelimiter(), *PathEnv, *InPathToGitBinary, *OutParameters);
+	}
+#endif
+}
+
+FGitProcess::~FGitProcess()
+{
+	if(ProcessHandle.IsValid())
+	{
+		if(FPlatformProcess::IsProcRunning(ProcessHandle))
+		{
+			Terminate();
+		}
+		FPlatformProcess::CloseProc(ProcessHandle);
+	}
+	FPlatformProcess::ClosePipe(StdOutRead, StdOutWrite);
+	FPlatformProcess::ClosePipe(StdErrRead, StdErrWrite);
+	FPlatformProcess::ClosePipe(StdInRead, StdInWrite);
+}
+
+bool FGitProcess::Launch(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InCommandLine, const bool bInWithStdIn /* = false */)
+{
+	check(!ProcessHandle.IsValid());
+
+	FString Executable;
+	FString Parameters;
+	GetGitCommandLine(InPathToGitBinary, InRepositoryRoot, InCommandLine, Executable, Parameters);
+
+	verify(FPlatformProcess::CreatePipe(StdOutRead, StdOutWrite));
+#if GIT_PROCESS_WITH_STDERR_PIPE
+	verify(FPlatformProcess::CreatePipe(StdErrRead, StdErrWrite));
+#endif
+	if(bInWithStdIn)
+	{
+		// the writing end of this pipe stays in this process (not inherited by the child)
+		verify(FPlatformProcess::CreatePipe(StdInRead, StdInWrite, true));
+	}
+
+	const bool bLaunchDetached = false;
+	const bool bLaunchHidden = true;
+	const bool bLaunchReallyHidden = bLaunchHidden;
+#if GIT_PROCESS_WITH_STDERR_PIPE
+	ProcessHandle = FPlatformProcess::CreateProc(*Executable, *Parameters, bLaunchDetached, bLaunchHidden, bLaunchReallyHidden, nullptr, 0, nullptr, StdOutWrite, StdInRead, StdErrWrite);
+#else
+	ProcessHandle = FPlatformProcess::CreateProc(*Executable, *Parameters, bLaunchDetached, bLaunchHidden, bLaunchReallyHidden, nullptr, 0, nullptr, StdOutWrite, StdInRead);
+#endif
+	if(!ProcessHandle.IsValid())
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to launch 'git %s'"), *InCommandLine);
+	}
+
+	return ProcessHandle.IsValid();
+}
+
+bool FGitProcess::IsRunning()
+{
+	return ProcessHandle.IsValid() && FPlatformProcess::IsProcRunning(ProcessHandle);
+}
+
+bool FGitProcess::WriteStdIn(const uint8* InData, const int32 InDataLength)
+{
+	int32 TotalWritten = 0;
+	while(TotalWritten < InDataLength)
+	{
+		int32 Written = 0;
+		FPlatformProcess::WritePipe(StdInWrite, InData + TotalWritten, InDataLength - TotalWritten, &Written);
+		if(Written > 0)
+		{
+			TotalWritten += Written;
+		}
+		else if(IsRunning())
+		{
+			// the pipe is full: wait for the process to read from it
+			FPlatformProcess::Sleep(0.001f);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FGitProcess::WriteStdIn(const FString& InString)
+{
+	FTCHARToUTF8 Utf8String(*InString);
+	return WriteStdIn(reinterpret_cast<const uint8*>(Utf8String.Get()), Utf8String.Length());
+}
+
+void FGitProcess::CloseStdIn()
+{
+	FPlatformProcess::ClosePipe(nullptr, StdInWrite);
+	StdInWrite = nullptr;
+}
+
+bool FGitProcess::ReadStdOut(TArray<uint8>& OutData)
+{
+	TArray<uint8> Data;
+	FPlatformProcess::ReadPipeToArray(StdOutRead, Data);
+	if(Data.Num() > 0)
+	{
+		OutData.Append(MoveTemp(Data));
+		return true;
+	}
+	return false;
+}
+
+FString FGitProcess::ReadStdErr()
+{
+	return (StdErrRead != nullptr) ? FPlatformProcess::ReadPipe(StdErrRead) : FString();
+}
+
+int32 FGitProcess::GetReturnCode()
+{
+	int32 ReturnCode = -1;
+	FPlatformProcess::GetProcReturnCode(ProcessHandle, &ReturnCode);
+	return ReturnCode;
+}
+
+void FGitProcess::Terminate()
+{
+	const bool bKillTree = true; // also kill git-lfs, ssh and any other process launched by Git
+	FPlatformProcess::TerminateProc(ProcessHandle, bKillTree);
+}
+
+
+/**
+ * Register a running Git process with the command executed by the current worker thread (if any) for its lifetime,
+ * so that cancelling the command terminates the process (see FGitSourceControlCommand::Cancel())
+ */
+class FGitScopedRunningProcess
+{
+public:
+	explicit FGitScopedRunningProcess(FGitProcess& InProcess)
+		: Process(InProcess)
+		, Command(FGitSourceControlCommand::GetCurrentCommand())
+	{
+		if(Command)
+		{
+			Command->AddRunningProcess(Process);
+		}
+	}
+
+	~FGitScopedRunningProcess()
+	{
+		if(Command)
+		{
+			Command->RemoveRunningProcess(Process);
+		}
+	}
+
+private:
+	FGitProcess& Process;
+	FGitSourceControlCommand* Command;
+};
+
+/**
+ * Watchdog of a Git process, terminating it once it did not output anything for the timeout of its kind (local, or contacting the remote),
+ * for instance when it waits for a credential or an SSH host key confirmation that nobody will ever give.
+ * Transfers report their progress (see RunCommandInternalRaw()), so a long but working one is never terminated,
+ * and commands writing to the repository locally have a longer budget, since terminating them could leave it half-modified.
+ * Checked by the thread polling the outputs of the process.
+ */
+class FGitProcessWatchdog
+{
+public:
+	FGitProcessWatchdog(const FString& InCommand, const TArray<FString>& InParameters)
+		: Command(InCommand)
+		, bNetwork(IsNetworkCommand(InCommand, InParameters))
+	{
+		const FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+		if(bNetwork)
+		{
+			Timeout = GitSourceControl.AccessSettings().GetNetworkCommandTimeout();
+		}
+		else if(IsLocalWriteCommand(InCommand))
+		{
+			Timeout = GitSourceControl.AccessSettings().GetLocalWriteCommandTimeout();
+		}
+		else
+		{
+			Timeout = GitSourceControl.AccessSettings().GetLocalCommandTimeout();
+		}
+		Deadline = FPlatformTime::Seconds() + Timeout;
+	}
+
+	/** Tells if a Git command writes to the repository without contacting the remote */
+	static bool IsLocalWriteCommand(const FString& InCommand)
+	{
+		return (InCommand == TEXT("add")) || (InCommand == TEXT("rm")) || (InCommand == TEXT("mv")) || (InCommand == TEXT("commit"))
+			|| (InCommand == TEXT("reset")) || (InCommand == TEXT("checkout")) || (InCommand == TEXT("restore")) || (InCommand == TEXT("clean"))
+			|| (InCommand == TEXT("merge")) || (InCommand == TEXT("rebase")) || (InCommand == TEXT("stash")) || (InCommand == TEXT("revert"));
+	}
+
+	/** Tells if a Git command can report the progress of its transfer with "--progress", even when its standard error is not a terminal */
+	static bool HasProgressOption(const FString& InCommand)
+	{
+		return (InCommand == TEXT("push")) || (InCommand == TEXT("pull")) || (InCommand == TEXT("fetch"));
+	}
+
+	/** Tells if a Git command contacts the remote */
+	static bool IsNetworkCommand(const FString& InCommand, const TArray<FString>& InParameters)
+	{
+		if((InCommand == TEXT("push")) || (InCommand == TEXT("pull")) || (InCommand == TEXT("fetch")) || (InCommand == TEXT("ls-remote"))
+			|| (InCommand == TEXT("lfs lock")) || (InCommand == TEXT("lfs unlock")))
+		{
+			return true;
+		}
+		if(InCommand == TEXT("lfs locks"))
+		{
+			return !InParameters.Contains(TEXT("--local")); // the locks cached by Git LFS
+		}
+		if(InCommand == TEXT("lfs"))
+		{
+			return (InParameters.Num() > 0) && ((InParameters[0] == TEXT("push")) || (InParameters[0] == TEXT("pull")) || (InParameters[0] == TEXT("fetch")));
+		}
+		return false;
+	}
+
+	/** Tells if the Git command contacts the remote */
+	bool IsNetwork() const
+	{
+		return bNetwork;
+	}
+
+	/**
+	 * Terminate the process if past its deadline, and report it to the command executed by the current thread, if any
+	 * @param	bInOutput	Tells if the process output anything since the last check, moving its deadline forward
+	 */
+	void Check(FGitProcess& InProcess, const bool bInOutput)
+	{
+		if(bTimedOut || (Timeout <= 0))
+		{
+			return;
+		}
+		const double Now = FPlatformTime::Seconds();
+		if(bInOutput)
+		{
+			Deadline = Now + Timeout;
+			return;
+		}
+		if(Now < Deadline)
+		{
+			return;
+		}
+
+		bTimedOut = true;
+		UE_LOG(LogSourceControl, Warning, TEXT("'git %s' timed out, without any output for %d seconds: terminating it"), *Command, Timeout);
+		InProcess.Terminate();
+		if(FGitSourceControlCommand* CurrentCommand = FGitSourceControlCommand::GetCurrentCommand())
+		{
+			CurrentCommand->bTimedOut = true;
+			CurrentCommand->bConnectionDropped |= bNetwork;
+		}
+		if(bNetwork)
+		{
+			FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+			GitSourceControl.GetProvider().MarkRemoteOffline();
+		}
+	}
+
+	/** Tells if the process was terminated for running past its deadline */
+	bool HasTimedOut() const
+	{
+		return bTimedOut;
+	}
+
+	/** Error message of the timeout */
+	FString GetErrorMessage() const
+	{
+		return FString::Printf(TEXT("Timeout: 'git %s' did not output anything for %d seconds%s"), *Command, Timeout, bNetwork ? TEXT(" (remote unreachable?)") : TEXT(""));
+	}
+
+private:
+	FString Command;
+	bool bNetwork;
+	/** Timeout in seconds, or 0 for none */
+	int32 Timeout = 0;
+	/** FPlatformTime::Seconds() at which to terminate the process, unless it outputs something before */
+	double Deadline = 0.0;
+	bool bTimedOut = false;
+};
+
 
 namespace GitSourceControlUtils
 {
 
+// Find the repository from where to run a Git command on the given files
+static FString GetCommandRepositoryRoot(const FString& InRepositoryRoot, const TArray<FString>& InFiles)
+{
+	if(!InRepositoryRoot.IsEmpty())
+	{
+		// Detect a "migrate asset" scenario (a "git add" command is applied to files outside the current project)
+		if ( (InFiles.Num() > 0) && !FPaths::IsRelative(InFiles[0]) && !InFiles[0].StartsWith(InRepositoryRoot) )
+		{
+			// in this case, find the git repository (if any) of the destination Project
+			FString DestinationRepositoryRoot;
+			if(FindRootDirectory(FPaths::GetPath(InFiles[0]), DestinationRepositoryRoot))
+			{
+				return DestinationRepositoryRoot; // if found use it for the "add" command (else not, to avoid producing one more error in logs)
+			}
+		}
+	}
+	return InRepositoryRoot;
+}
+
+// Build the command line of a Git command, and find the repository from where to run it
+static void BuildCommandLine(const FString& InCommand, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, FString& OutRepositoryRoot, FString& OutCommandLine)
+{
+	OutRepositoryRoot = GetCommandRepositoryRoot(InRepositoryRoot, InFiles);
+	OutCommandLine.Reset();
+
+	// the git command itself ("status", "log", "commit"...)
+	OutCommandLine += InCommand;
+
+	// Append to the command all parameters, and then finally the files
+	for(const auto& Parameter : InParameters)
+	{
+		OutCommandLine += TEXT(" ");
+		OutCommandLine += Parameter;
+	}
+	for(const auto& File : InFiles)
+	{
+		OutCommandLine += TEXT(" \"");
+		OutCommandLine += File;
+		OutCommandLine += TEXT("\"");
+	}
+	// Also, Git does not have a "--non-interactive" option, as it auto-detects when there are no connected standard input/output streams
+}
+
+#if GIT_PROCESS_WITH_STDERR_PIPE
+/** Keep only the last update of each progress line ("Receiving objects:  42% (42/100)\r" overwritten until "... done.\n") */
+static void RemoveProgressUpdates(FString& InOutErrors)
+{
+	TArray<FString> Lines;
+	InOutErrors.ParseIntoArray(Lines, TEXT("\n"), true);
+	InOutErrors.Reset();
+	for(const FString& Line : Lines)
+	{
+		TArray<FString> Updates;
+		Line.ParseIntoArray(Updates, TEXT("\r"), true);
+		if(Updates.Num() > 0)
+		{
+			InOutErrors += Updates.Last();
+			InOutErrors += TEXT("\n");
+		}
+	}
+}
+#endif
+
 // Launch the Git command line process and extract its results & errors
 bool RunCommandInternalRaw(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, FString& OutResults, FString& OutErrors, const int32 ExpectedReturnCode /* = 0 */)
 {
 	int32 ReturnCode = 0;
-	FString FullCommand;
+	TArray<FString> Parameters(InParameters);
+#if GIT_PROCESS_WITH_STDERR_PIPE
+	if(FGitProcessWatchdog::HasProgressOption(InCommand))
+	{
+		// Report the progress of the transfer (not a terminal, so silent by default), so that the watchdog sees it alive
+		Parameters.Insert(TEXT("--progress"), 0);
+	}
+#endif
+	FString RepositoryRoot;
 	FString LogableCommand; // short version of the command for logging purpose
+	BuildCommandLine(InCommand, InRepositoryRoot, Parameters, InFiles, RepositoryRoot, LogableCommand);
 
-	if(!InRepositoryRoot.IsEmpty())
+	UE_LOG(LogSourceControl, Log, TEXT("RunCommand: 'git %s'"), *LogableCommand);
+
+	if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
+	{
+		return false;
+	}
+
+	// Circuit breaker: do not even try to contact a remote that just timed out
+	double RemoteOfflineTime = 0.0;
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	if(FGitProcessWatchdog::IsNetworkCommand(InCommand, InParameters) && GitSourceControl.GetProvider().IsRemoteOffline(RemoteOfflineTime))
+	{
+		if(FGitSourceControlCommand* CurrentCommand = FGitSourceControlCommand::GetCurrentCommand())
+		{
+			CurrentCommand->bConnectionDropped = true;
+		}
+		OutErrors = FString::Printf(TEXT("Remote offline: 'git %s' skipped, retrying in %.0f seconds"), *InCommand, RemoteOfflineTime);
+		UE_LOG(LogSourceControl, Warning, TEXT("%s"), *OutErrors);
+		return false;
+	}
+
+#if GIT_PROCESS_WITH_STDERR_PIPE
+	// Read the outputs of the process while it is running, so that it can be terminated if the command is cancelled or times out
+	FGitProcessWatchdog Watchdog(InCommand, InParameters);
+	FGitProcess Process;
+	if(!Process.Launch(InPathToGitBinary, RepositoryRoot, LogableCommand))
+	{
+		OutErrors = FString::Printf(TEXT("Failed to launch 'git %s'"), *InCommand);
+		return false;
+	}
+	{
+		FGitScopedRunningProcess ScopedRunningProcess(Process);
+		TArray<uint8> Output;
+		while(true)
+		{
+			// Check the process before reading, so that nothing written just before exiting is missed
+			const bool bRunning = Process.IsRunning();
+			const bool bRead = Process.ReadStdOut(Output);
+			const FString Errors = Process.ReadStdErr();
+			OutErrors += Errors;
+			Watchdog.Check(Process, bRead || !Errors.IsEmpty());
+			if(!bRead && !bRunning)
+			{
+				break;
+			}
+			else if(!bRead)
+			{
+				FPlatformProcess::Sleep(0.001f);
+			}
+		}
+		FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Output.GetData()), Output.Num());
+		OutResults = FString(Converter.Length(), Converter.Get());
+	}
+	if(FGitProcessWatchdog::HasProgressOption(InCommand))
+	{
+		RemoveProgressUpdates(OutErrors);
+	}
+	ReturnCode = Process.GetReturnCode();
+	if(Watchdog.HasTimedOut())
+	{
+		OutErrors += Watchdog.GetErrorMessage() + TEXT("\n");
+		UE_LOG(LogSourceControl, Warning, TEXT("RunCommand(%s) ReturnCode=%d:\n%s"), *InCommand, ReturnCode, *OutErrors);
+		return false;
+	}
+#else
+	// Before UE5.1 the standard error can only be read separately from the output of a process launched by ExecProcess(), that can neither be terminated nor timed out
+	FString PathToGitOrEnvBinary;
+	FString FullCommand;
+	GetGitCommandLine(InPathToGitBinary, RepositoryRoot, LogableCommand, PathToGitOrEnvBinary, FullCommand);
+	FPlatformProcess::ExecProcess(*PathToGitOrEnvBinary, *FullCommand, &ReturnCode, &OutResults, &OutErrors);
+#endif
+
+	// TODO: add a setting to easily enable Verbose logging
+	UE_LOG(LogSourceControl, Verbose, TEXT("RunCommand(%s):\n%s"), *InCommand, *OutResults);
+	if(ReturnCode != ExpectedReturnCode || OutErrors.Len() > 0)
+	{
+		UE_LOG(LogSourceControl, Warning, TEXT("RunCommand(%s) ReturnCode=%d:\n%s"), *InCommand, ReturnCode, *OutErrors);
+	}
+
+	// Move push/pull progress information from the error stream to the info stream
+	if(ReturnCode == ExpectedReturnCode && OutErrors.Len() > 0)
+	{
+		OutResults.Append(OutErrors);
+		OutErrors.Empty();
+	}
+
+	return ReturnCode == ExpectedReturnCode;
+}
+
+// Basic parsing or results & errors from the Git command line process
+static bool RunCommandInternal(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, TArray<FString>& OutResults, TArray<FString>& OutErrorMessages)
+{
+	bool bResult;
+	FString Results;
+	FString Errors;
+
+	bResult = RunCommandInternalRaw(InCommand, InPathToGitBinary, InRepositoryRoot, InParameters, InFiles, Results, Errors);
+	Results.ParseIntoArray(OutResults, TEXT("\n"), true);
+	Errors.ParseIntoArray(OutErrorMessages, TEXT("\n"), true);
+
+	return bResult;
+}
+
+/**
+ * Split the output of a Git process into records (lines, or NUL-terminated records of the "-z" option) as soon as they are read,
+ * passing each non-empty one to a callback, without ever holding more than one incomplete record.
+ */
+class FGitOutputSplitter
+{
+public:
+	FGitOutputSplitter(const TCHAR InDelimiter, const TFunctionRef<void(const FString&)>& InCallback)
+		: Delimiter(static_cast<uint8>(InDelimiter))
+		, Callback(InCallback)
+	{
+		check(InDelimiter < 128); // a delimiter is never part of a multi-byte UTF-8 sequence
+	}
+
+	/** Consume all complete records of the buffer, keeping the last incomplete one unless this is the end of the output */
+	void Split(TArray<uint8>& InOutBuffer, const bool bInEndOfOutput)
+	{
+		int32 RecordStart = 0;
+		for(int32 Index = ScanFrom; Index < InOutBuffer.Num(); Index++)
+		{
+			if(InOutBuffer[Index] == Delimiter)
+			{
+				DispatchRecord(InOutBuffer.GetData() + RecordStart, Index - RecordStart);
+				RecordStart = Index + 1;
+			}
+		}
+		if(bInEndOfOutput && RecordStart < InOutBuffer.Num())
+		{
+			// Last record without a trailing delimiter
+			DispatchRecord(InOutBuffer.GetData() + RecordStart, InOutBuffer.Num() - RecordStart);
+			RecordStart = InOutBuffer.Num();
+		}
+		InOutBuffer.RemoveAt(0, RecordStart, false);
+		ScanFrom = InOutBuffer.Num();
+	}
+
+private:
+	void DispatchRecord(const uint8* InData, int32 InLength)
+	{
+		if(Delimiter == '\n' && InLength > 0 && InData[InLength - 1] == '\r')
+		{
+			InLength--; // Windows line endings
+		}
+		if(InLength > 0) // skip empty lines, like FString::ParseIntoArray() does
+		{
+			FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(InData), InLength);
+			Record.Reset();
+			Record.AppendChars(Converter.Get(), Converter.Length());
+			Callback(Record);
+		}
+	}
+
+	const uint8 Delimiter;
+	TFunctionRef<void(const FString&)> Callback;
+	int32 ScanFrom = 0;	///< Bytes already scanned for a delimiter
+	FString Record;		///< Reused for each record to avoid one allocation per line
+};
+
+#if !GIT_PROCESS_WITH_STDERR_PIPE
+/**
+ * Convert a line output by 'git status', 'git ls-files' or 'git diff' without "-z" to the records it would have output with it:
+ * unquote the filenames (quoted with C-style escapes when they contain special characters, even with core.quotePath=false),
+ * and split the renamed or copied entries into their two records ("XY orig -> path" in porcelain v1, "2 ... path<TAB>orig" in v2)
+ */
+static void ConvertLineToRecords(const FString& InLine, const bool bInStatus, const TFunctionRef<void(const FString&)>& InCallback)
+{
+	const bool bRenameV1 = bInStatus && (InLine.Len() > 3) && ((InLine[0] == TEXT('R')) || (InLine[0] == TEXT('C')));
+	TArray<FString> Fields; // the line split on the separators found outside of quotes
+	Fields.AddDefaulted();
+	TArray<ANSICHAR> Bytes; // consecutive octal escapes, that are the UTF-8 bytes of one character
+	auto FlushBytes = [&Fields, &Bytes]()
+	{
+		if(Bytes.Num() > 0)
+		{
+			FUTF8ToTCHAR Converter(Bytes.GetData(), Bytes.Num());
+			Fields.Last().AppendChars(Converter.Get(), Converter.Length());
+			Bytes.Reset();
+		}
+	};
+	bool bQuoted = false;
+	for(int32 Index = 0; Index < InLine.Len(); Index++)
 	{
-		FString RepositoryRoot = InRepositoryRoot;
-
-		// Detect a "migrate asset" scenario (a "git add" command is applied to files outside the current project)
-		if ( (InFiles.Num() > 0) && !FPaths::IsRelative(InFiles[0]) && !InFiles[0].StartsWith(InRepositoryRoot) )
+		const TCHAR Char = InLine[Index];
+		if(bQuoted && (Char == TEXT('\\')) && (Index + 1 < InLine.Len()))
 		{
-			// in this case, find the git repository (if any) of the destination Project
-			FString DestinationRepositoryRoot;
-			if(FindRootDirectory(FPaths::GetPath(InFiles[0]), DestinationRepositoryRoot))
+			const TCHAR Escaped = InLine[++Index];
+			if((Escaped >= TEXT('0')) && (Escaped <= TEXT('7')))
+			{
+				int32 Byte = 0;
+				for(int32 Digit = 0; (Digit < 3) && (Index < InLine.Len()) && (InLine[Index] >= TEXT('0')) && (InLine[Index] <= TEXT('7')); Digit++)
+				{
+					Byte = Byte * 8 + (InLine[Index++] - TEXT('0'));
+				}
+				Index--;
+				Bytes.Add(static_cast<ANSICHAR>(Byte));
+				continue;
+			}
+			FlushBytes();
+			switch(Escaped)
 			{
-				RepositoryRoot = DestinationRepositoryRoot; // if found use it for the "add" command (else not, to avoid producing one more error in logs)
+			case TEXT('a'): Fields.Last().AppendChar(TEXT('\a')); break;
+			case TEXT('b'): Fields.Last().AppendChar(TEXT('\b')); break;
+			case TEXT('f'): Fields.Last().AppendChar(TEXT('\f')); break;
+			case TEXT('n'): Fields.Last().AppendChar(TEXT('\n')); break;
+			case TEXT('r'): Fields.Last().AppendChar(TEXT('\r')); break;
+			case TEXT('t'): Fields.Last().AppendChar(TEXT('\t')); break;
+			case TEXT('v'): Fields.Last().AppendChar(TEXT('\v')); break;
+			default: Fields.Last().AppendChar(Escaped); break; // backslash and double quote
 			}
+			continue;
+		}
+		FlushBytes();
+		if(Char == TEXT('"'))
+		{
+			bQuoted = !bQuoted;
+		}
+		else if(!bQuoted && (Char == TEXT('\t')))
+		{
+			Fields.AddDefaulted();
+		}
+		else if(!bQuoted && bRenameV1 && (Fields.Num() == 1) && (FCString::Strncmp(*InLine + Index, TEXT(" -> "), 4) == 0))
+		{
+			Fields.AddDefaulted();
+			Index += 3;
+		}
+		else
+		{
+			Fields.Last().AppendChar(Char);
 		}
-
-		// Specify the working copy (the root) of the git repository (before the command itself)
-		FullCommand  = TEXT("-C \"");
-		FullCommand += RepositoryRoot;
-		FullCommand += TEXT("\" ");
 	}
-	// then the git command itself ("status", "log", "commit"...)
-	LogableCommand += InCommand;
+	FlushBytes();
 
-	// Append to the command all parameters, and then finally the files
-	for(const auto& Parameter : InParameters)
+	if(bRenameV1 && (Fields.Num() == 2))
 	{
-		LogableCommand += TEXT(" ");
-		LogableCommand += Parameter;
+		// "XY orig -> path" is output as "XY path" followed by "orig" with "-z"
+		InCallback(Fields[0].Left(3) + Fields[1]);
+		InCallback(Fields[0].RightChop(3));
 	}
-	for(const auto& File : InFiles)
+	else
 	{
-		LogableCommand += TEXT(" \"");
-		LogableCommand += File;
-		LogableCommand += TEXT("\"");
+		for(const FString& Field : Fields)
+		{
+			InCallback(Field);
+		}
 	}
-	// Also, Git does not have a "--non-interactive" option, as it auto-detects when there are no connected standard input/output streams
+}
+#endif
 
-	FullCommand += LogableCommand;
+// Launch the Git command line process and pass its output record by record to the callback while it is still running
+bool RunCommandStreamed(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, const TCHAR InDelimiter, const TFunctionRef<void(const FString&)>& InCallback, TArray<FString>& OutErrorMessages)
+{
+#if !GIT_PROCESS_WITH_STDERR_PIPE
+	// Before UE5.1 the standard error of a process cannot be read separately from its standard output,
+	// so fall back to the buffered ExecProcess() to keep error messages out of the parsed results.
+	// But ExecProcess() stops at the first NUL character, so instead of NUL-terminated records ("-z"),
+	// read lines with the filenames quoted only if they contain special characters (not for non-ASCII ones, with core.quotePath=false)
+	TArray<FString> Parameters(InParameters);
+	const bool bNulTerminated = (InDelimiter == '\0') && (Parameters.Remove(TEXT("-z")) > 0);
+	FString Results;
+	FString Errors;
+	const bool bResult = RunCommandInternalRaw(bNulTerminated ? TEXT("-c core.quotePath=false ") + InCommand : InCommand, InPathToGitBinary, InRepositoryRoot, Parameters, InFiles, Results, Errors);
+	TArray<uint8> Buffer;
+	FTCHARToUTF8 Utf8Results(*Results);
+	Buffer.Append(reinterpret_cast<const uint8*>(Utf8Results.Get()), Utf8Results.Length());
+	if(bNulTerminated)
+	{
+		const bool bStatus = (InCommand == TEXT("status"));
+		FGitOutputSplitter(TEXT('\n'), [bStatus, &InCallback](const FString& InLine)
+		{
+			ConvertLineToRecords(InLine, bStatus, InCallback);
+		}).Split(Buffer, true);
+	}
+	else
+	{
+		FGitOutputSplitter(InDelimiter, InCallback).Split(Buffer, true);
+	}
+	TArray<FString> ErrorMessages;
+	Errors.ParseIntoArray(ErrorMessages, TEXT("\n"), true);
+	OutErrorMessages.Append(MoveTemp(ErrorMessages));
+	return bResult;
+#else
+	FString RepositoryRoot;
+	FString LogableCommand; // short version of the command for logging purpose
+	BuildCommandLine(InCommand, InRepositoryRoot, InParameters, InFiles, RepositoryRoot, LogableCommand);
 
-	UE_LOG(LogSourceControl, Log, TEXT("RunCommand: 'git %s'"), *LogableCommand);
+	UE_LOG(LogSourceControl, Log, TEXT("RunCommandStreamed: 'git %s'"), *LogableCommand);
 
-	FString PathToGitOrEnvBinary = InPathToGitBinary;
-#if PLATFORM_MAC
-	// The Cocoa application does not inherit shell environment variables, so add the path expected to have git-lfs to PATH
-	FString PathEnv = FPlatformMisc::GetEnvironmentVariable(TEXT("PATH"));
-	FString GitInstallPath = FPaths::GetPath(InPathToGitBinary);
+	if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
+	{
+		return false;
+	}
 
-	TArray<FString> PathArray;
-	PathEnv.ParseIntoArray(PathArray, FPlatformMisc::GetPathVarDelimiter());
-	bool bHasGitInstallPath = false;
-	for (auto Path : PathArray)
+	FGitProcessWatchdog Watchdog(InCommand, InParameters);
+	FGitProcess Process;
+	if(!Process.Launch(InPathToGitBinary, RepositoryRoot, LogableCommand))
 	{
-		if (GitInstallPath.Equals(Path, ESearchCase::CaseSensitive))
+		OutErrorMessages.Add(FString::Printf(TEXT("Failed to launch 'git %s'"), *InCommand));
+		return false;
+	}
+	FGitScopedRunningProcess ScopedRunningProcess(Process);
+
+	FGitOutputSplitter Splitter(InDelimiter, InCallback);
+	TArray<uint8> Buffer;
+	FString Errors;
+	while(true)
+	{
+		// Check the process before reading, so that nothing written just before exiting is missed
+		const bool bRunning = Process.IsRunning();
+		const bool bRead = Process.ReadStdOut(Buffer);
+		// Also drain the standard error, else Git would block on a full pipe
+		const FString NewErrors = Process.ReadStdErr();
+		Errors += NewErrors;
+		Watchdog.Check(Process, bRead || !NewErrors.IsEmpty());
+		if(bRead)
+		{
+			Splitter.Split(Buffer, false);
+		}
+		else if(!bRunning)
 		{
-			bHasGitInstallPath = true;
 			break;
 		}
+		else
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
 	}
+	Splitter.Split(Buffer, true);
 
-	if (!bHasGitInstallPath)
+	if(Watchdog.HasTimedOut())
 	{
-		PathToGitOrEnvBinary = FString("/usr/bin/env");
-		FullCommand = FString::Printf(TEXT("PATH=\"%s%s%s\" \"%s\" %s"), *GitInstallPath, FPlatformMisc::GetPathVarDelimiter(), *PathEnv, *InPathToGitBinary, *FullCommand);
+		OutErrorMessages.Add(Watchdog.GetErrorMessage());
+		return false;
 	}
-#endif
-	FPlatformProcess::ExecProcess(*PathToGitOrEnvBinary, *FullCommand, &ReturnCode, &OutResults, &OutErrors);
 
-	// TODO: add a setting to easily enable Verbose logging
-	UE_LOG(LogSourceControl, Verbose, TEXT("RunCommand(%s):\n%s"), *InCommand, *OutResults);
-	if(ReturnCode != ExpectedReturnCode || OutErrors.Len() > 0)
+	const int32 ReturnCode = Process.GetReturnCode();
+	if(ReturnCode != 0 || Errors.Len() > 0)
 	{
-		UE_LOG(LogSourceControl, Warning, TEXT("RunCommand(%s) ReturnCode=%d:\n%s"), *InCommand, ReturnCode, *OutErrors);
+		UE_LOG(LogSourceControl, Warning, TEXT("RunCommandStreamed(%s) ReturnCode=%d:\n%s"), *InCommand, ReturnCode, *Errors);
 	}
-
-	// Move push/pull progress information from the error stream to the info stream
-	if(ReturnCode == ExpectedReturnCode && OutErrors.Len() > 0)
+	if(ReturnCode != 0)
 	{
-		OutResults.Append(OutErrors);
-		OutErrors.Empty();
+		TArray<FString> ErrorMessages;
+		Errors.ParseIntoArray(ErrorMessages, TEXT("\n"), true);
+		OutErrorMessages.Append(MoveTemp(ErrorMessages));
 	}
 
-	return ReturnCode == ExpectedReturnCode;
-}
-
-// Basic parsing or results & errors from the Git command line process
-static bool RunCommandInternal(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, TArray<FString>& OutResults, TArray<FString>& OutErrorMessages)
-{
-	bool bResult;
-	FString Results;
-	FString Errors;
-
-	bResult = RunCommandInternalRaw(InCommand, InPathToGitBinary, InRepositoryRoot, InParameters, InFiles, Results, Errors);
-	Results.ParseIntoArray(OutResults, TEXT("\n"), true);
-	Errors.ParseIntoArray(OutErrorMessages, TEXT("\n"), true);
-
-	return bResult;
+	return ReturnCode == 0;
+#endif
 }
 
 FString FindGitBinaryPath()
@@ -402,6 +1079,10 @@ void FindGitCapabilities(const FString& InPathToGitBinary, FGitVersion *OutVersi
 	{
 		OutVersion->bHasCatFileWithFilters = true;
 	}
+	// "--pathspec-from-file" introduced in Git 2.25 for add, reset, commit, checkout and restore, then in Git 2.26 for rm
+	OutVersion->bHasPathspecFromFile = OutVersion->IsGreaterOrEqualThan(2, 26);
+	// "--no-optional-locks" introduced in Git 2.15
+	OutVersion->bHasNoOptionalLocks = OutVersion->IsGreaterOrEqualThan(2, 15);
 }
 
 void FindGitLfsCapabilities(const FString& InPathToGitBinary, FGitVersion *OutVersion)
@@ -491,6 +1172,13 @@ void GetUserConfig(const FString& InPathToGitBinary, const FString& InRepository
 
 bool GetBranchName(const FString& InPathToGitBinary, const FString& InRepositoryRoot, FString& OutBranchName)
 {
+	// Read the HEAD of the repository directly, without launching Git
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	if(GitSourceControl.GetProvider().GetRepositoryReader().GetBranchName(InRepositoryRoot, OutBranchName))
+	{
+		return true;
+	}
+
 	bool bResults;
 	TArray<FString> InfoMessages;
 	TArray<FString> ErrorMessages;
@@ -525,6 +1213,16 @@ bool GetBranchName(const FString& InPathToGitBinary, const FString& InRepository
 
 bool GetCommitInfo(const FString& InPathToGitBinary, const FString& InRepositoryRoot, FString& OutCommitId, FString& OutCommitSummary)
 {
+	// Read the current commit directly, and only launch Git to get the summary of a new one
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	FGitRepositoryReader& RepositoryReader = GitSourceControl.GetProvider().GetRepositoryReader();
+	FString CommitId;
+	if(RepositoryReader.GetCommitId(InRepositoryRoot, CommitId) && !CommitId.IsEmpty() && RepositoryReader.FindCommitSummary(CommitId, OutCommitSummary))
+	{
+		OutCommitId = MoveTemp(CommitId);
+		return true;
+	}
+
 	bool bResults;
 	TArray<FString> InfoMessages;
 	TArray<FString> ErrorMessages;
@@ -534,8 +1232,15 @@ bool GetCommitInfo(const FString& InPathToGitBinary, const FString& InRepository
 	bResults = RunCommandInternal(TEXT("log"), InPathToGitBinary, InRepositoryRoot, Parameters, TArray<FString>(), InfoMessages, ErrorMessages);
 	if(bResults && InfoMessages.Num() > 0)
 	{
-		OutCommitId = InfoMessages[0].Left(40);
-		OutCommitSummary = InfoMessages[0].RightChop(41);
+		// The id is followed by a space (SHA1 or SHA256)
+		int32 SpaceIndex;
+		if(!InfoMessages[0].FindChar(TEXT(' '), SpaceIndex))
+		{
+			SpaceIndex = InfoMessages[0].Len();
+		}
+		OutCommitId = InfoMessages[0].Left(SpaceIndex);
+		OutCommitSummary = InfoMessages[0].RightChop(SpaceIndex + 1);
+		RepositoryReader.AddCommitSummary(OutCommitId, OutCommitSummary);
 	}
 
 	return bResults;
@@ -543,6 +1248,13 @@ bool GetCommitInfo(const FString& InPathToGitBinary, const FString& InRepository
 
 bool GetRemoteUrl(const FString& InPathToGitBinary, const FString& InRepositoryRoot, FString& OutRemoteUrl)
 {
+	// Read the config of the repository directly, without launching Git
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	if(GitSourceControl.GetProvider().GetRepositoryReader().GetRemoteUrl(InRepositoryRoot, TEXT("origin"), OutRemoteUrl))
+	{
+		return !OutRemoteUrl.IsEmpty();
+	}
+
 	TArray<FString> InfoMessages;
 	TArray<FString> ErrorMessages;
 	TArray<FString> Parameters;
@@ -557,22 +1269,191 @@ bool GetRemoteUrl(const FString& InPathToGitBinary, const FString& InRepositoryR
 	return bResults;
 }
 
+/** Tells if a Git command accepts its files on its standard input with "--pathspec-from-file=-" */
+static bool IsPathspecFromFileSupported(const FString& InCommand)
+{
+#if GIT_PROCESS_WITH_STDERR_PIPE
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	if(GitSourceControl.GetProvider().GetGitVersion().bHasPathspecFromFile)
+	{
+		// NOTE: "status" and "ls-files" do not support it (yet)
+		return (InCommand == TEXT("add")) || (InCommand == TEXT("rm")) || (InCommand == TEXT("reset")) || (InCommand == TEXT("checkout")) || (InCommand == TEXT("restore")) || (InCommand == TEXT("commit"));
+	}
+#endif
+	// Before UE5.1 the standard error cannot be told apart from the output of a process fed through its standard input
+	return false;
+}
+
+// Run a Git command with all its files given on its standard input, so that any number of files can be handled by a single process
+static bool RunCommandWithPathspecFromFile(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, TArray<FString>& OutResults, TArray<FString>& OutErrorMessages)
+{
+	TArray<FString> Parameters = InParameters;
+	Parameters.Add(TEXT("--pathspec-from-file=-"));
+	Parameters.Add(TEXT("--pathspec-file-nul"));
+
+	FString RepositoryRoot;
+	FString LogableCommand; // short version of the command for logging purpose
+	BuildCommandLine(InCommand, GetCommandRepositoryRoot(InRepositoryRoot, InFiles), Parameters, TArray<FString>(), RepositoryRoot, LogableCommand);
+
+	UE_LOG(LogSourceControl, Log, TEXT("RunCommand: 'git %s' (%d files)"), *LogableCommand, InFiles.Num());
+
+	if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
+	{
+		return false;
+	}
+
+	FGitProcessWatchdog Watchdog(InCommand, InParameters);
+	FGitProcess Process;
+	const bool bWithStdIn = true;
+	if(!Process.Launch(InPathToGitBinary, RepositoryRoot, LogableCommand, bWithStdIn))
+	{
+		OutErrorMessages.Add(FString::Printf(TEXT("Failed to launch 'git %s'"), *InCommand));
+		return false;
+	}
+	FGitScopedRunningProcess ScopedRunningProcess(Process);
+
+	// Write the NUL-terminated files by chunks, draining the outputs in between, so that Git never blocks on a full pipe while we block on a full stdin
+	TArray<uint8> Output;
+	FString Errors;
+	TArray<uint8> Chunk;
+	for(int32 FileIndex = 0; FileIndex < InFiles.Num(); )
+	{
+		Chunk.Reset();
+		for(; FileIndex < InFiles.Num() && Chunk.Num() < 4096; FileIndex++)
+		{
+			FTCHARToUTF8 Utf8File(*InFiles[FileIndex]);
+			Chunk.Append(reinterpret_cast<const uint8*>(Utf8File.Get()), Utf8File.Length());
+			Chunk.Add('\0');
+		}
+		if(!Process.WriteStdIn(Chunk.GetData(), Chunk.Num()))
+		{
+			break; // the process exited early, its return code and errors tell why
+		}
+		Process.ReadStdOut(Output);
+		Errors += Process.ReadStdErr();
+		Watchdog.Check(Process, true); // Git is reading the files
+	}
+	Process.CloseStdIn();
+
+	while(true)
+	{
+		const bool bRunning = Process.IsRunning();
+		const bool bRead = Process.ReadStdOut(Output);
+		const FString NewErrors = Process.ReadStdErr();
+		Errors += NewErrors;
+		Watchdog.Check(Process, bRead || !NewErrors.IsEmpty());
+		if(!bRead && !bRunning)
+		{
+			break;
+		}
+		else if(!bRead)
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
+	}
+
+	if(Watchdog.HasTimedOut())
+	{
+		OutErrorMessages.Add(Watchdog.GetErrorMessage());
+		return false;
+	}
+
+	const int32 ReturnCode = Process.GetReturnCode();
+	FUTF8ToTCHAR Utf8Output(reinterpret_cast<const ANSICHAR*>(Output.GetData()), Output.Num());
+	const FString Results(Utf8Output.Length(), Utf8Output.Get());
+	UE_LOG(LogSourceControl, Verbose, TEXT("RunCommand(%s):\n%s"), *InCommand, *Results);
+	if(ReturnCode != 0 || Errors.Len() > 0)
+	{
+		UE_LOG(LogSourceControl, Warning, TEXT("RunCommand(%s) ReturnCode=%d:\n%s"), *InCommand, ReturnCode, *Errors);
+	}
+
+	TArray<FString> ResultLines;
+	Results.ParseIntoArray(ResultLines, TEXT("\n"), true);
+	OutResults.Append(MoveTemp(ResultLines));
+	TArray<FString> ErrorLines;
+	Errors.ParseIntoArray(ErrorLines, TEXT("\n"), true);
+	OutErrorMessages.Append(MoveTemp(ErrorLines));
+
+	return ReturnCode == 0;
+}
+
+/** Get the maximum length of a command line on this platform */
+static int32 GetMaxCommandLineLength()
+{
+#if PLATFORM_WINDOWS
+	return GitSourceControlConstants::MaxCommandLineLength;
+#else
+	// ARG_MAX is shared between the arguments and the environment, so keep half of it for the latter
+	const long ArgMax = sysconf(_SC_ARG_MAX);
+	return (ArgMax > 0) ? static_cast<int32>(FMath::Min<long>(ArgMax / 2, MAX_int32)) : 4096;
+#endif
+}
+
+/**
+ * Split files into batches as big as the command line limits of the platform allows
+ *
+ * @param	InPathToGitBinary	The path to the Git binary
+ * @param	InRepositoryRoot	The Git repository from where to run the command
+ * @param	InCommand			The Git command - e.g. commit
+ * @param	InParameters		The parameters to the Git command
+ * @param	InFiles				The files to be operated on
+ * @param	OutBatches			The files, split into batches
+ */
+static void SplitFilesIntoBatches(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InCommand, const TArray<FString>& InParameters, const TArray<FString>& InFiles, TArray<TArray<FString>>& OutBatches)
+{
+	FString RepositoryRoot;
+	FString CommandLine;
+	BuildCommandLine(InCommand, InRepositoryRoot, InParameters, TArray<FString>(), RepositoryRoot, CommandLine);
+	FString Executable;
+	FString FullCommandLine;
+	GetGitCommandLine(InPathToGitBinary, RepositoryRoot, CommandLine, Executable, FullCommandLine);
+	const int32 FixedLength = Executable.Len() + FullCommandLine.Len() + GitSourceControlConstants::CommandLineMargin;
+	const int32 MaxLength = GetMaxCommandLineLength();
+#if !PLATFORM_WINDOWS
+	// Conservative count of the arguments before the files: "-C", root, command, parameters (and "/usr/bin/env PATH=" under Mac)
+	const int32 MaxFiles = FMath::Max(1, GitSourceControlConstants::MaxCommandLineArguments - InParameters.Num() - 16);
+#endif
+
+	int32 Length = FixedLength;
+	for(const FString& File : InFiles)
+	{
+		const int32 FileLength = File.Len() + 3; // space and double quotes
+		const bool bNewBatch = (OutBatches.Num() == 0) || (Length + FileLength > MaxLength)
+#if !PLATFORM_WINDOWS
+			|| (OutBatches.Last().Num() >= MaxFiles)
+#endif
+			;
+		if(bNewBatch)
+		{
+			OutBatches.AddDefaulted();
+			Length = FixedLength;
+		}
+		OutBatches.Last().Add(File);
+		Length += FileLength;
+	}
+}
+
 bool RunCommand(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, TArray<FString>& OutResults, TArray<FString>& OutErrorMessages)
 {
 	bool bResult = true;
 
-	if(InFiles.Num() > GitSourceControlConstants::MaxFilesPerBatch)
+	if((InFiles.Num() > 1) && IsPathspecFromFileSupported(InCommand))
+	{
+		// Feed all the files through the standard input of a single process
+		bResult = RunCommandWithPathspecFromFile(InCommand, InPathToGitBinary, InRepositoryRoot, InParameters, InFiles, OutResults, OutErrorMessages);
+	}
+	else if(InFiles.Num() > 1)
 	{
 		// Batch files up so we dont exceed command-line limits
-		int32 FileCount = 0;
-		while(FileCount < InFiles.Num())
+		TArray<TArray<FString>> Batches;
+		SplitFilesIntoBatches(InPathToGitBinary, InRepositoryRoot, InCommand, InParameters, InFiles, Batches);
+		for(const TArray<FString>& FilesInBatch : Batches)
 		{
-			TArray<FString> FilesInBatch;
-			for(int32 FileIndex = 0; FileCount < InFiles.Num() && FileIndex < GitSourceControlConstants::MaxFilesPerBatch; FileIndex++, FileCount++)
+			if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
 			{
-				FilesInBatch.Add(InFiles[FileCount]);
+				bResult = false;
+				break; // skip the remaining batches
 			}
-
 			TArray<FString> BatchResults;
 			TArray<FString> BatchErrors;
 			bResult &= RunCommandInternal(InCommand, InPathToGitBinary, InRepositoryRoot, InParameters, FilesInBatch, BatchResults, BatchErrors);
@@ -588,24 +1469,48 @@ bool RunCommand(const FString& InCommand, const FString& InPathToGitBinary, cons
 	return bResult;
 }
 
-// Run a Git "commit" command by batches
+// Run a Git command for the files of all the operations batched into a command, and if it fails, again for the files of each operation
+bool RunBatchedCommand(const FString& InCommand, FGitSourceControlCommand& InOutCommand)
+{
+	TArray<FString> InfoMessages;
+	TArray<FString> ErrorMessages;
+	const bool bResult = RunCommand(InCommand, InOutCommand.PathToGitBinary, InOutCommand.PathToRepositoryRoot, TArray<FString>(), InOutCommand.Files, InfoMessages, ErrorMessages);
+	if(bResult || (InOutCommand.MergedOperations.Num() == 0) || FGitSourceControlCommand::IsCurrentCommandInterrupted())
+	{
+		InOutCommand.InfoMessages.Append(MoveTemp(InfoMessages));
+		InOutCommand.ErrorMessages.Append(MoveTemp(ErrorMessages));
+		return bResult;
+	}
+
+	// Git stops at the first file in error without touching the other ones, so find out which operations fail by running it for each of them
+	UE_LOG(LogSourceControl, Log, TEXT("RunBatchedCommand(%s): failed for %d operations, running it for each one"), *InCommand, InOutCommand.MergedOperations.Num() + 1);
+	for(FGitMergedOperation& MergedOperation : InOutCommand.MergedOperations)
+	{
+		MergedOperation.bOwnResult = true;
+		MergedOperation.bSuccessful = RunCommand(InCommand, InOutCommand.PathToGitBinary, InOutCommand.PathToRepositoryRoot, TArray<FString>(), MergedOperation.Files, MergedOperation.InfoMessages, MergedOperation.ErrorMessages);
+	}
+	return RunCommand(InCommand, InOutCommand.PathToGitBinary, InOutCommand.PathToRepositoryRoot, TArray<FString>(), InOutCommand.OperationFiles, InOutCommand.InfoMessages, InOutCommand.ErrorMessages);
+}
+
+// Run a Git "commit" command with all files at once (through the standard input) or else by batches
 bool RunCommit(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, TArray<FString>& OutResults, TArray<FString>& OutErrorMessages)
 {
 	bool bResult = true;
 
-	if(InFiles.Num() > GitSourceControlConstants::MaxFilesPerBatch)
+	TArray<TArray<FString>> Batches;
+	if(IsPathspecFromFileSupported(TEXT("commit")))
 	{
-		// Batch files up so we dont exceed command-line limits
-		int32 FileCount = 0;
-		{
-			TArray<FString> FilesInBatch;
-			for(int32 FileIndex = 0; FileIndex < GitSourceControlConstants::MaxFilesPerBatch; FileIndex++, FileCount++)
-			{
-				FilesInBatch.Add(InFiles[FileCount]);
-			}
-			// First batch is a simple "git commit" command with only the first files
-			bResult &= RunCommandInternal(TEXT("commit"), InPathToGitBinary, InRepositoryRoot, InParameters, FilesInBatch, OutResults, OutErrorMessages);
-		}
+		Batches.Add(InFiles);
+	}
+	else
+	{
+		SplitFilesIntoBatches(InPathToGitBinary, InRepositoryRoot, TEXT("commit"), InParameters, InFiles, Batches);
+	}
+
+	if(Batches.Num() > 1)
+	{
+		// First batch is a simple "git commit" command with only the first files
+		bResult &= RunCommandInternal(TEXT("commit"), InPathToGitBinary, InRepositoryRoot, InParameters, Batches[0], OutResults, OutErrorMessages);
 
 		TArray<FString> Parameters;
 		for(const auto& Parameter : InParameters)
@@ -614,104 +1519,195 @@ bool RunCommit(const FString& InPathToGitBinary, const FString& InRepositoryRoot
 		}
 		Parameters.Add(TEXT("--amend"));
 
-		while(FileCount < InFiles.Num())
+		for(int32 BatchIndex = 1; BatchIndex < Batches.Num(); BatchIndex++)
 		{
-			TArray<FString> FilesInBatch;
-			for(int32 FileIndex = 0; FileCount < InFiles.Num() && FileIndex < GitSourceControlConstants::MaxFilesPerBatch; FileIndex++, FileCount++)
+			if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
 			{
-				FilesInBatch.Add(InFiles[FileCount]);
+				bResult = false;
+				break; // skip the remaining batches
 			}
 			// Next batches "amend" the commit with some more files
 			TArray<FString> BatchResults;
 			TArray<FString> BatchErrors;
-			bResult &= RunCommandInternal(TEXT("commit"), InPathToGitBinary, InRepositoryRoot, Parameters, FilesInBatch, BatchResults, BatchErrors);
+			bResult &= RunCommandInternal(TEXT("commit"), InPathToGitBinary, InRepositoryRoot, Parameters, Batches[BatchIndex], BatchResults, BatchErrors);
 			OutResults += BatchResults;
 			OutErrorMessages += BatchErrors;
 		}
 	}
 	else
 	{
-		bResult = RunCommandInternal(TEXT("commit"), InPathToGitBinary, InRepositoryRoot, InParameters, InFiles, OutResults, OutErrorMessages);
+		bResult = RunCommand(TEXT("commit"), InPathToGitBinary, InRepositoryRoot, InParameters, InFiles, OutResults, OutErrorMessages);
 	}
 
 	return bResult;
 }
 
-/**
- * Parse informations on a file locked with Git LFS
- *
- * Example output of "git lfs locks"
-Content\ThirdPersonBP\Blueprints\ThirdPersonCharacter.uasset    SRombauts       ID:891
-Content\ThirdPersonBP\Blueprints\ThirdPersonGameMode.uasset     SRombauts       ID:896
- */
-class FGitLfsLocksParser
+/** One entry of the results of a Git status command: the two letters status of a file */
+struct FGitStatusRecord
 {
-public:
-	FGitLfsLocksParser(const FString& InRepositoryRoot, const FString& InStatus, const bool bAbsolutePaths = true)
-	{
-		TArray<FString> Informations;
-		InStatus.ParseIntoArray(Informations, TEXT("\t"), true);
-		if(Informations.Num() >= 3)
-		{
-			Informations[0].TrimEndInline(); // Trim whitespace from the end of the filename
-			Informations[1].TrimEndInline(); // Trim whitespace from the end of the username
-			if (bAbsolutePaths)
-				LocalFilename = FPaths::ConvertRelativePathToFull(InRepositoryRoot, Informations[0]);
-			else
-				LocalFilename = Informations[0];
-			LockUser = MoveTemp(Informations[1]);
-		}
-	}
-
-	FString LocalFilename;	///< Filename on disk
-	FString LockUser;		///< Name of user who has file locked
+	TCHAR IndexState;	///< Status of the file in the index, ' ' if unmodified
+	TCHAR WCopyState;	///< Status of the file in the working tree, ' ' if unmodified
+	FString Filename;	///< Filename relative to the repository root (the new one in case of a rename, ending with a slash for a directory)
 };
 
 /**
- * @brief Extract the relative filename from a Git status result.
+ * @brief Parse the NUL-terminated records of a "git status --porcelain=v2 -z" command (or "--porcelain -z" for Git before 2.11) as they are read.
  *
- * Examples of status results:
-M  Content/Textures/T_Perlin_Noise_M.uasset
-R  Content/Textures/T_Perlin_Noise_M.uasset -> Content/Textures/T_Perlin_Noise_M2.uasset
+ * Examples of porcelain v2 status records (one per line here, for readability):
+1 .M N... 100644 100644 100644 3f8d5ab0fe6e8c8bbdd52b8e2aea4e9d0d0e0cc6 3f8d5ab0fe6e8c8bbdd52b8e2aea4e9d0d0e0cc6 Content/Textures/T_Perlin_Noise_M.uasset
+2 R. N... 100644 100644 100644 a14347dc3b589b78fb19ba62a7e3982f343718bc a14347dc3b589b78fb19ba62a7e3982f343718bc R100 Content/Textures/T_Perlin_Noise_M2.uasset
+Content/Textures/T_Perlin_Noise_M.uasset
+u UU N... 100644 100644 100644 100644 d9b33098273547b57c0af314136f35b494e16dcb a14347dc3b589b78fb19ba62a7e3982f343718bc f3137a7167c840847cd7bd2bf07eefbfb2d9bcd2 Content/Blueprints/BP_Test.uasset
+? Content/Materials/M_Basic_Wall.uasset
+! Saved/
+ *
+ * Examples of porcelain v1 status records:
+ M Content/Textures/T_Perlin_Noise_M.uasset
+R  Content/Textures/T_Perlin_Noise_M2.uasset
+Content/Textures/T_Perlin_Noise_M.uasset
 ?? Content/Materials/M_Basic_Wall.uasset
 !! BasicCode.sln
  *
- * @param[in] InResult One line of status
- * @return Relative filename extracted from the line of status
- *
- * @see FGitStatusFileMatcher and StateFromGitStatus()
+ * With "-z", filenames are never quoted, and the original filename of a rename or copy comes as a record of its own.
  */
-static FString FilenameFromGitStatus(const FString& InResult)
+class FGitStatusRecordParser
 {
-	int32 RenameIndex;
-	if(InResult.FindLastChar('>', RenameIndex))
+public:
+	FGitStatusRecordParser(const bool bInPorcelainV2, TArray<FGitStatusRecord>& OutRecords)
+		: bPorcelainV2(bInPorcelainV2)
+		, Records(OutRecords)
 	{
-		// Extract only the second part of a rename "from -> to"
-		return InResult.RightChop(RenameIndex + 2);
 	}
-	else
+
+	void ParseRecord(const FString& InRecord)
 	{
-		// Extract the relative filename from the Git status result (after the 2 letters status and 1 space)
-		return InResult.RightChop(3);
+		if(bSkipOriginalFilename)
+		{
+			// Original filename of the previous rename or copy record
+			bSkipOriginalFilename = false;
+			return;
+		}
+
+		if(bPorcelainV2)
+		{
+			switch(InRecord[0])
+			{
+			case TEXT('1'): // Ordinary changed entry
+				AddRecord(InRecord[2], InRecord[3], InRecord, 8);
+				break;
+			case TEXT('2'): // Renamed or copied entry, followed by its original filename
+				AddRecord(InRecord[2], InRecord[3], InRecord, 9);
+				bSkipOriginalFilename = true;
+				break;
+			case TEXT('u'): // Unmerged entry
+				AddRecord(InRecord[2], InRecord[3], InRecord, 10);
+				break;
+			case TEXT('?'): // Untracked file
+			case TEXT('!'): // Ignored file or directory
+				Records.Add({ InRecord[0], InRecord[0], InRecord.RightChop(2) });
+				break;
+			default: // "#" headers
+				break;
+			}
+		}
+		else if(InRecord.Len() > 3)
+		{
+			Records.Add({ InRecord[0], InRecord[1], InRecord.RightChop(3) });
+			bSkipOriginalFilename = (InRecord[0] == TEXT('R')) || (InRecord[0] == TEXT('C'));
+		}
 	}
-}
 
-/** Match the relative filename of a Git status result with a provided absolute filename */
-class FGitStatusFileMatcher
+private:
+	/** Add a record with its filename found after the given number of fields separated by spaces ('.' means unmodified in porcelain v2) */
+	void AddRecord(const TCHAR InIndexState, const TCHAR InWCopyState, const FString& InRecord, const int32 InFieldsBeforeFilename)
+	{
+		int32 Index = 0;
+		for(int32 Field = 0; Field < InFieldsBeforeFilename && Index != INDEX_NONE; Field++)
+		{
+			Index = InRecord.Find(TEXT(" "), ESearchCase::CaseSensitive, ESearchDir::FromStart, Index) + 1;
+			Index = (Index > 0) ? Index : INDEX_NONE;
+		}
+		if(Index != INDEX_NONE)
+		{
+			Records.Add({ (InIndexState == TEXT('.')) ? TEXT(' ') : InIndexState, (InWCopyState == TEXT('.')) ? TEXT(' ') : InWCopyState, InRecord.RightChop(Index) });
+		}
+		else
+		{
+			UE_LOG(LogSourceControl, Warning, TEXT("Unexpected status record '%s'"), *InRecord);
+		}
+	}
+
+	const bool bPorcelainV2;
+	TArray<FGitStatusRecord>& Records;
+	bool bSkipOriginalFilename = false;
+};
+
+/**
+ * Status records indexed by their filename relative to the repository root, for a constant time lookup of each file
+ * (instead of a search through all the records, that could also match the wrong file when one path is a suffix of another)
+ */
+class FGitStatusRecordIndex
 {
 public:
-	FGitStatusFileMatcher(const FString& InAbsoluteFilename)
-		: AbsoluteFilename(InAbsoluteFilename)
+	FGitStatusRecordIndex(const FString& InRepositoryRoot, const TArray<FGitStatusRecord>& InRecords)
+		: RepositoryRoot(InRepositoryRoot)
 	{
+		FPaths::NormalizeFilename(RepositoryRoot);
+		if(!RepositoryRoot.IsEmpty() && !RepositoryRoot.EndsWith(TEXT("/")))
+		{
+			RepositoryRoot += TEXT("/");
+		}
+
+		Records.Reserve(InRecords.Num());
+		for(const FGitStatusRecord& Record : InRecords)
+		{
+			if(Record.Filename.EndsWith(TEXT("/")))
+			{
+				// Ignored (or untracked) directory reported as a whole
+				Directories.Add(Record.Filename.LeftChop(1), &Record);
+			}
+			else
+			{
+				Records.Add(Record.Filename, &Record);
+			}
+		}
 	}
 
-	bool operator()(const FString& InResult) const
+	/** Find the status record of a file, or of the directory containing it if reported as a whole, given its absolute filename */
+	const FGitStatusRecord* Find(const FString& InAbsoluteFilename) const
 	{
-		return AbsoluteFilename.Contains(FilenameFromGitStatus(InResult));
+		FString Filename = InAbsoluteFilename;
+		FPaths::NormalizeFilename(Filename);
+		if(!Filename.StartsWith(RepositoryRoot))
+		{
+			return nullptr;
+		}
+		Filename.RightChopInline(RepositoryRoot.Len(), false);
+
+		if(const FGitStatusRecord* const* Record = Records.Find(Filename))
+		{
+			return *Record;
+		}
+		if(Directories.Num() > 0)
+		{
+			for(FString Parent = FPaths::GetPath(Filename); !Parent.IsEmpty(); Parent = FPaths::GetPath(Parent))
+			{
+				if(const FGitStatusRecord* const* Record = Directories.Find(Parent))
+				{
+					return *Record;
+				}
+			}
+		}
+		return nullptr;
 	}
 
 private:
-	const FString& AbsoluteFilename;
+	/** Normalized root of the repository, ending with a slash */
+	FString RepositoryRoot;
+	/** Records of files, by relative filename */
+	TMap<FString, const FGitStatusRecord*> Records;
+	/** Records of directories, by relative path without the trailing slash */
+	TMap<FString, const FGitStatusRecord*> Directories;
 };
 
 /**
@@ -730,10 +1726,8 @@ private:
 class FGitStatusParser
 {
 public:
-	FGitStatusParser(const FString& InResult)
+	FGitStatusParser(const TCHAR IndexState, const TCHAR WCopyState)
 	{
-		TCHAR IndexState = InResult[0];
-		TCHAR WCopyState = InResult[1];
 		if(   (IndexState == 'U' || WCopyState == 'U')
 		   || (IndexState == 'A' && WCopyState == 'A')
 		   || (IndexState == 'D' && WCopyState == 'D'))
@@ -784,10 +1778,19 @@ public:
 	EWorkingCopyState::Type State;
 };
 
+/** The stages of an unmerged (conflicted) file in the index */
+struct FGitConflictStages
+{
+	/** Id of the blob of the stages 1, 2 and 3 (warning: not the commit Id), empty if the stage is missing (ie. file added on both sides) */
+	FString FileIds[3];
+	/** Filename relative to the repository root */
+	FString Filename;
+};
+
 /**
- * Extract the status of a unmerged (conflict) file
+ * Extract the stages of all the unmerged (conflict) files
  *
- * Example output of git ls-files --unmerged Content/Blueprints/BP_Test.uasset
+ * Example output of git ls-files --unmerged -z (one record per stage, each terminated by a NUL character instead of a newline)
 100644 d9b33098273547b57c0af314136f35b494e16dcb 1	Content/Blueprints/BP_Test.uasset
 100644 a14347dc3b589b78fb19ba62a7e3982f343718bc 2	Content/Blueprints/BP_Test.uasset
 100644 f3137a7167c840847cd7bd2bf07eefbfb2d9bcd2 3	Content/Blueprints/BP_Test.uasset
@@ -795,27 +1798,58 @@ public:
  * 1: The "common ancestor" of the file (the version of the file that both the current and other branch originated from).
  * 2: The version from the current branch (the master branch in this case).
  * 3: The version from the other branch (the test branch)
+ *
+ * Fields are separated by a space, and the filename by a tab, so object ids can be SHA-1 (40 chars) or SHA-256 (64 chars)
 */
-class FGitConflictStatusParser
+class FGitUnmergedParser
 {
 public:
-	/** Parse the unmerge status: extract the base SHA1 identifier of the file */
-	FGitConflictStatusParser(const TArray<FString>& InResults)
+	FGitUnmergedParser(TMap<FString, FGitConflictStages>& InOutConflicts)
+		: Conflicts(InOutConflicts)
 	{
-#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3
-		const FString& CommonAncestor = InResults[0]; // 1: The common ancestor of merged branches
-		CommonAncestorFileId = CommonAncestor.Mid(7, 40);
-		CommonAncestorFilename = CommonAncestor.Right(50);
+	}
 
-		if (ensure(InResults.IsValidIndex(2)))
+	void ParseRecord(const FString& InRecord)
+	{
+		int32 TabIndex;
+		if(!InRecord.FindChar(TEXT('\t'), TabIndex))
 		{
-			const FString& RemoteBranch = InResults[2]; // 1: The common ancestor of merged branches
-			RemoteFileId = RemoteBranch.Mid(7, 40);
-			RemoteFilename = RemoteBranch.Right(50);
+			return;
 		}
-#else
-		const FString& FirstResult = InResults[0]; // 1: The common ancestor of merged branches
-		CommonAncestorFileId = FirstResult.Mid(7, 40);
+		const FString Infos = InRecord.Left(TabIndex);
+		TArray<FString> Fields;
+		Infos.ParseIntoArray(Fields, TEXT(" "), true);
+		if((Fields.Num() != 3) || (Fields[2].Len() != 1))
+		{
+			return;
+		}
+		const int32 Stage = Fields[2][0] - TEXT('1');
+		if((Stage < 0) || (Stage > 2))
+		{
+			return;
+		}
+		FString Filename = InRecord.RightChop(TabIndex + 1);
+		FGitConflictStages& Stages = Conflicts.FindOrAdd(Filename);
+		Stages.FileIds[Stage] = MoveTemp(Fields[1]);
+		Stages.Filename = MoveTemp(Filename);
+	}
+
+private:
+	TMap<FString, FGitConflictStages>& Conflicts;
+};
+
+/** Extract the details of a conflict from its stages */
+class FGitConflictStatusParser
+{
+public:
+	/** Parse the unmerge status: extract the base SHA1 identifier of the file */
+	FGitConflictStatusParser(const FGitConflictStages& InStages)
+	{
+		CommonAncestorFileId = InStages.FileIds[0]; // 1: The common ancestor of merged branches
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3
+		CommonAncestorFilename = InStages.Filename;
+		RemoteFileId = InStages.FileIds[2]; // 3: The version from the other branch
+		RemoteFilename = InStages.Filename;
 #endif
 	}
 
@@ -828,29 +1862,38 @@ public:
 #endif
 };
 
-/** Execute a command to get the details of a conflict */
-static void RunGetConflictStatus(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InFile, FGitSourceControlState& InOutFileState)
+/** Execute a single command to get the stages of all the unmerged files of the repository, by relative filename */
+static bool RunGetConflicts(const FString& InPathToGitBinary, const FString& InRepositoryRoot, TMap<FString, FGitConflictStages>& OutConflicts)
 {
 	TArray<FString> ErrorMessages;
-	TArray<FString> Results;
-	TArray<FString> Files;
-	Files.Add(InFile);
 	TArray<FString> Parameters;
 	Parameters.Add(TEXT("--unmerged"));
-	bool bResult = RunCommandInternal(TEXT("ls-files"), InPathToGitBinary, InRepositoryRoot, Parameters, Files, Results, ErrorMessages);
-	if(bResult && Results.Num() == 3)
+	Parameters.Add(TEXT("-z")); // filenames are never quoted
+	FGitUnmergedParser Parser(OutConflicts);
+	return RunCommandStreamed(TEXT("ls-files"), InPathToGitBinary, InRepositoryRoot, Parameters, TArray<FString>(), TEXT('\0'), [&Parser](const FString& InRecord)
+	{
+		Parser.ParseRecord(InRecord);
+	}, ErrorMessages);
+}
+
+/** Fill the details of a conflict from the stages of the file */
+static void SetConflictStatus(const FGitConflictStages& InStages, FGitSourceControlState& InOutFileState)
+{
+	if(InStages.FileIds[0].IsEmpty())
 	{
-		// Parse the unmerge status: extract the base revision (or the other branch?)
-		FGitConflictStatusParser ConflictStatus(Results);
+		return; // no common ancestor to merge from
+	}
+
+	// Parse the unmerge status: extract the base revision (or the other branch?)
+	FGitConflictStatusParser ConflictStatus(InStages);
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3
-		InOutFileState.PendingResolveInfo.BaseFile = ConflictStatus.CommonAncestorFilename;
-		InOutFileState.PendingResolveInfo.BaseRevision = ConflictStatus.CommonAncestorFileId;
-		InOutFileState.PendingResolveInfo.RemoteFile = ConflictStatus.RemoteFilename;
-		InOutFileState.PendingResolveInfo.RemoteRevision = ConflictStatus.RemoteFileId;
+	InOutFileState.PendingResolveInfo.BaseFile = ConflictStatus.CommonAncestorFilename;
+	InOutFileState.PendingResolveInfo.BaseRevision = ConflictStatus.CommonAncestorFileId;
+	InOutFileState.PendingResolveInfo.RemoteFile = ConflictStatus.RemoteFilename;
+	InOutFileState.PendingResolveInfo.RemoteRevision = ConflictStatus.RemoteFileId;
 #else
-		InOutFileState.PendingMergeBaseFileHash = ConflictStatus.CommonAncestorFileId;
+	InOutFileState.PendingMergeBaseFileHash = ConflictStatus.CommonAncestorFileId;
 #endif
-	}
 }
 
 /// Convert filename relative to the repository root to absolute path (inplace)
@@ -862,54 +1905,78 @@ void AbsoluteFilenames(const FString& InRepositoryRoot, TArray<FString>& InFileN
 	}
 }
 
-/** Run a 'git ls-files' command to get all files tracked by Git recursively in a directory.
+/** Run a 'git ls-files' command to get all files tracked by Git recursively in some directories.
  *
  * Called in case of a "directory status" (no file listed in the command) when using the "Submit to Source Control" menu.
 */
-static bool ListFilesInDirectoryRecurse(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InDirectory, TArray<FString>& OutFiles)
+static bool ListFilesInDirectories(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InDirectories, TArray<FString>& OutFiles)
 {
+	bool bResult = true;
 	TArray<FString> ErrorMessages;
-	TArray<FString> Directory;
-	Directory.Add(InDirectory);
-	const bool bResult = RunCommandInternal(TEXT("ls-files"), InPathToGitBinary, InRepositoryRoot, TArray<FString>(), Directory, OutFiles, ErrorMessages);
-	AbsoluteFilenames(InRepositoryRoot, OutFiles);
+	TArray<FString> Parameters;
+	Parameters.Add(TEXT("-z")); // filenames are never quoted
+	TArray<TArray<FString>> Batches;
+	SplitFilesIntoBatches(InPathToGitBinary, InRepositoryRoot, TEXT("ls-files"), Parameters, InDirectories, Batches);
+	for(const TArray<FString>& Directories : Batches)
+	{
+		if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
+		{
+			bResult = false;
+			break; // skip the remaining batches
+		}
+		bResult &= RunCommandStreamed(TEXT("ls-files"), InPathToGitBinary, InRepositoryRoot, Parameters, Directories, TEXT('\0'), [&InRepositoryRoot, &OutFiles](const FString& InFile)
+		{
+			OutFiles.Add(FPaths::ConvertRelativePathToFull(InRepositoryRoot, InFile));
+		}, ErrorMessages);
+	}
 	return bResult;
 }
 
-/** Parse the array of strings results of a 'git status' command for a provided list of files all in a common directory
+/** Parse the records of a 'git status' command for a provided list of files
  *
  * Called in case of a normal refresh of status on a list of assets in a the Content Browser (or user selected "Refresh" context menu).
  *
- * Example git status results:
-M  Content/Textures/T_Perlin_Noise_M.uasset
-R  Content/Textures/T_Perlin_Noise_M.uasset -> Content/Textures/T_Perlin_Noise_M2.uasset
-?? Content/Materials/M_Basic_Wall.uasset
-!! BasicCode.sln
+ * @see FGitStatusRecordParser for examples of 'git status' records
 */
-static void ParseFileStatusResult(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InFiles, const TMap<FString, FString>& InLockedFiles, const TArray<FString>& InResults, TArray<FGitSourceControlState>& OutStates)
+static void ParseFileStatusResult(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InFiles, const TMap<FString, FString>& InLockedFiles, const TArray<FGitStatusRecord>& InResults, TArray<FGitSourceControlState>& OutStates)
 {
 	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
 	const FString LfsUserName = GitSourceControl.AccessSettings().GetLfsUserName();
 	const FDateTime Now = FDateTime::Now();
 
+	// Index the status results once, by filename
+	const FGitStatusRecordIndex ResultIndex(InRepositoryRoot, InResults);
+
+	// Stages of all the conflicted files, read at the first one
+	TMap<FString, FGitConflictStages> Conflicts;
+	bool bConflictsRead = false;
+
 	// Iterate on all files explicitly listed in the command
 	for(const auto& File : InFiles)
 	{
 		FGitSourceControlState FileState(File, InUsingLfsLocking);
-		// Search the file in the list of status
-		int32 IdxResult = InResults.IndexOfByPredicate(FGitStatusFileMatcher(File));
-		if(IdxResult != INDEX_NONE)
+		// Search the file in the status results
+		if(const FGitStatusRecord* ResultPtr = ResultIndex.Find(File))
 		{
 			// File found in status results; only the case for "changed" files
-			FGitStatusParser StatusParser(InResults[IdxResult]);
+			const FGitStatusRecord& Result = *ResultPtr;
+			FGitStatusParser StatusParser(Result.IndexState, Result.WCopyState);
 			// TODO LFS Debug log
-			UE_LOG(LogSourceControl, Log, TEXT("Status(%s) = '%s' => %d"), *File, *InResults[IdxResult], static_cast<int>(StatusParser.State));
+			UE_LOG(LogSourceControl, Log, TEXT("Status(%s) = '%c%c' => %d"), *File, Result.IndexState, Result.WCopyState, static_cast<int>(StatusParser.State));
 
 			FileState.WorkingCopyState = StatusParser.State;
 			if(FileState.IsConflicted())
 			{
 				// In case of a conflict (unmerged file) get the base revision to merge
-				RunGetConflictStatus(InPathToGitBinary, InRepositoryRoot, File, FileState);
+				if(!bConflictsRead)
+				{
+					RunGetConflicts(InPathToGitBinary, InRepositoryRoot, Conflicts);
+					bConflictsRead = true;
+				}
+				if(const FGitConflictStages* Stages = Conflicts.Find(Result.Filename))
+				{
+					SetConflictStatus(*Stages, FileState);
+				}
 			}
 		}
 		else
@@ -932,8 +1999,9 @@ static void ParseFileStatusResult(const FString& InPathToGitBinary, const FStrin
 		}
 		if(InLockedFiles.Contains(File))
 		{
-			FileState.LockUser = InLockedFiles[File];
-			if(LfsUserName == FileState.LockUser)
+			const FString& LockUser = InLockedFiles[File];
+			FileState.LockUser = FName(*LockUser);
+			if(LfsUserName == LockUser)
 			{
 				FileState.LockState = ELockState::Locked;
 			}
@@ -942,7 +2010,7 @@ static void ParseFileStatusResult(const FString& InPathToGitBinary, const FStrin
 				FileState.LockState = ELockState::LockedOther;
 			}
 			// TODO LFS Debug log
-			UE_LOG(LogSourceControl, Log, TEXT("Status(%s) Locked by '%s'"), *File, *FileState.LockUser);
+			UE_LOG(LogSourceControl, Log, TEXT("Status(%s) Locked by '%s'"), *File, *LockUser);
 		}
 		else
 		{
@@ -958,23 +2026,39 @@ static void ParseFileStatusResult(const FString& InPathToGitBinary, const FStrin
 	}
 }
 
-/** Parse the array of strings results of a 'git status' command for a directory
+/** Tells if a path is in one of the given directories (with or without a trailing slash), or in one of their subdirectories */
+static bool IsInDirectories(const FString& InPath, const TSet<FString>& InDirectories)
+{
+	for(FString Parent = FPaths::GetPath(InPath); !Parent.IsEmpty(); Parent = FPaths::GetPath(Parent))
+	{
+		if(InDirectories.Contains(Parent) || InDirectories.Contains(Parent + TEXT("/")))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Parse the records of a 'git status' command for some directories
  *
  *  Called in case of a "directory status" (no file listed in the command) ONLY to detect Deleted/Missing/Untracked files
  * since those files are not listed by the 'git ls-files' command.
  *
- * @see #ParseFileStatusResult() above for an example of a 'git status' results
+ * @see FGitStatusRecordParser for examples of 'git status' records
 */
-static void ParseDirectoryStatusResult(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InResults, TArray<FGitSourceControlState>& OutStates)
+static void ParseDirectoryStatusResult(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TSet<FString>& InDirectories, const TSet<FString>& InAlreadyParsedFiles, const TArray<FGitStatusRecord>& InResults, TArray<FGitSourceControlState>& OutStates)
 {
-	// Iterate on each line of result of the status command
-	for(const FString& Result : InResults)
+	// Iterate on each record of the status command (that can also be about files outside of these directories)
+	for(const FGitStatusRecord& Result : InResults)
 	{
-		const FString RelativeFilename = FilenameFromGitStatus(Result);
-		const FString File = FPaths::ConvertRelativePathToFull(InRepositoryRoot, RelativeFilename);
+		const FString File = FPaths::ConvertRelativePathToFull(InRepositoryRoot, Result.Filename);
+		if(!IsInDirectories(File, InDirectories) || InAlreadyParsedFiles.Contains(File))
+		{
+			continue;
+		}
 
 		FGitSourceControlState FileState(File, InUsingLfsLocking);
-		FGitStatusParser StatusParser(Result);
+		FGitStatusParser StatusParser(Result.IndexState, Result.WCopyState);
 		if((EWorkingCopyState::Deleted == StatusParser.State) || (EWorkingCopyState::Missing == StatusParser.State) || (EWorkingCopyState::NotControlled == StatusParser.State))
 		{
 			FileState.WorkingCopyState = StatusParser.State;
@@ -985,288 +2069,382 @@ static void ParseDirectoryStatusResult(const FString& InPathToGitBinary, const F
 }
 
 /**
- * @brief Detects how to parse the result of a "status" command to get workspace file states
- *
- *  It is either a command for a whole directory (ie. "Content/", in case of "Submit to Source Control" menu),
- * or for one or more files all on a same directory (by design, since we group files by directory in RunUpdateStatus())
+ * Run a single "git status" command on all the given paths (unless they do not fit into one command line), and parse its records as they are read
  *
  * @param[in]	InPathToGitBinary	The path to the Git binary
  * @param[in]	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory (can be empty)
- * @param[in]	InUsingLfsLocking	Tells if using the Git LFS file Locking workflow
- * @param[in]	InFiles				List of files in a directory, or the path to the directory itself (never empty).
- * @param[out]	InResults			Results from the "status" command
- * @param[out]	OutStates			States of files for witch the status has been gathered (distinct than InFiles in case of a "directory status")
+ * @param[in]	InPaths				Files and directories to get the status of
+ * @param[out]	OutErrorMessages	Any errors (from StdErr) as an array per-line
+ * @param[out]	OutRecords			Status records of all the changed, untracked and ignored files in these paths
  */
-static void ParseStatusResults(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InFiles, const TMap<FString, FString>& InLockedFiles, const TArray<FString>& InResults, TArray<FGitSourceControlState>& OutStates)
+static bool RunStatus(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InPaths, TArray<FString>& OutErrorMessages, TArray<FGitStatusRecord>& OutRecords)
 {
-	if((InFiles.Num() == 1) && FPaths::DirectoryExists(InFiles[0]))
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	const FGitVersion& GitVersion = GitSourceControl.GetProvider().GetGitVersion();
+	const bool bPorcelainV2 = GitVersion.IsGreaterOrEqualThan(2, 11);
+
+	TArray<FString> Parameters;
+	Parameters.Add(bPorcelainV2 ? TEXT("--porcelain=v2") : TEXT("--porcelain"));
+	Parameters.Add(TEXT("-z")); // filenames are never quoted
+	Parameters.Add(TEXT("--untracked-files=all"));
+	// Report ignored directories instead of each file they contain (now that untracked files are listed one by one)
+	Parameters.Add(GitVersion.IsGreaterOrEqualThan(2, 16) ? TEXT("--ignored=matching") : TEXT("--ignored"));
+
+	bool bResult = true;
+	FGitStatusRecordParser RecordParser(bPorcelainV2, OutRecords);
+	TArray<TArray<FString>> Batches;
+	SplitFilesIntoBatches(InPathToGitBinary, InRepositoryRoot, TEXT("status"), Parameters, InPaths, Batches);
+	for(const TArray<FString>& Paths : Batches)
 	{
-		// 1) Special case for "status" of a directory: requires to get the list of files by ourselves.
-		//   (this is triggered by the "Submit to Source Control" menu)
-		// TODO LFS Debug Log
-		UE_LOG(LogSourceControl, Log, TEXT("ParseStatusResults: 1) Special case for status of a directory (%s)"), *InFiles[0]);
-		TArray<FString> Files;
-		const FString& Directory = InFiles[0];
-		const bool bResult = ListFilesInDirectoryRecurse(InPathToGitBinary, InRepositoryRoot, Directory, Files);
-		if(bResult)
+		if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
 		{
-			ParseFileStatusResult(InPathToGitBinary, InRepositoryRoot, InUsingLfsLocking, Files, InLockedFiles, InResults, OutStates);
+			bResult = false;
+			break; // skip the remaining batches
 		}
-		// The above cannot detect deleted assets since there is no file left to enumerate (either by the Content Browser or by git ls-files)
-		// => so we also parse the status results to explicitly look for Deleted/Missing assets
-		ParseDirectoryStatusResult(InPathToGitBinary, InRepositoryRoot, InUsingLfsLocking, InResults, OutStates);
-	}
-	else
-	{
-		// 2) General case for one or more files in the same directory.
-		// TODO LFS Debug Log
-		UE_LOG(LogSourceControl, Log, TEXT("ParseStatusResults: 2) General case for one or more files (%s, ...)"), *InFiles[0]);
-		ParseFileStatusResult(InPathToGitBinary, InRepositoryRoot, InUsingLfsLocking, InFiles, InLockedFiles, InResults, OutStates);
+		bResult &= RunCommandStreamed(TEXT("status"), InPathToGitBinary, InRepositoryRoot, Parameters, Paths, TEXT('\0'), [&RecordParser](const FString& InRecord)
+		{
+			RecordParser.ParseRecord(InRecord);
+		}, OutErrorMessages);
 	}
+	return bResult;
 }
 
 bool GetAllLocks(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bAbsolutePaths, TArray<FString>& OutErrorMessages, TMap<FString, FString>& OutLocks)
 {
-	TArray<FString> Results;
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	return GitSourceControl.GetProvider().GetLfsLockCache().GetLocks(InPathToGitBinary, InRepositoryRoot, bAbsolutePaths, OutLocks, OutErrorMessages);
+}
+
+/**
+ * Get the files modified on the upstream branch since it diverged from the current branch, as of the last fetch
+ * (so without contacting the server, see RunFetch())
+ *
+ * @param[in]	InPathToGitBinary	The path to the Git binary
+ * @param[in]	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
+ * @param[out]	OutErrorMessages	Errors of Git, only when the branch is known to have an upstream branch
+ * @param[out]	OutFiles			The absolute filenames of the files modified upstream
+ * @returns false on errors of Git, but not if there is no upstream branch (no remote, local branch or detached HEAD)
+ */
+static bool GetFilesChangedUpstream(const FString& InPathToGitBinary, const FString& InRepositoryRoot, TArray<FString>& OutErrorMessages, TSet<FString>& OutFiles)
+{
+	// Without launching Git, skip the common cases where nothing can be newer: no upstream branch, or already up to date with it
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	FGitRepositoryReader& RepositoryReader = GitSourceControl.GetProvider().GetRepositoryReader();
+	FString UpstreamRef;
+	FString UpstreamCommitId;
+	FString CommitId;
+	const bool bKnownUpstream = RepositoryReader.GetUpstream(InRepositoryRoot, UpstreamRef, UpstreamCommitId) && RepositoryReader.GetCommitId(InRepositoryRoot, CommitId);
+	if(bKnownUpstream)
+	{
+		if(UpstreamCommitId.IsEmpty() || (UpstreamCommitId == CommitId))
+		{
+			return true;
+		}
+	}
+
+	TArray<FString> Parameters;
+	Parameters.Add(TEXT("--name-only"));
+	Parameters.Add(TEXT("-z")); // filenames are never quoted
+	Parameters.Add(TEXT("HEAD...@{upstream}")); // from the merge base of both branches to the upstream one
 	TArray<FString> ErrorMessages;
-	const bool bResult = RunCommand(TEXT("lfs locks"), InPathToGitBinary, InRepositoryRoot, TArray<FString>(), TArray<FString>(), Results, ErrorMessages);
-	for(const FString& Result : Results)
+	const bool bResult = RunCommandStreamed(TEXT("diff"), InPathToGitBinary, InRepositoryRoot, Parameters, TArray<FString>(), TEXT('\0'), [&InRepositoryRoot, &OutFiles](const FString& InFile)
 	{
-		FGitLfsLocksParser LockFile(InRepositoryRoot, Result, bAbsolutePaths);
-		// TODO LFS Debug log
-		UE_LOG(LogSourceControl, Log, TEXT("LockedFile(%s, %s)"), *LockFile.LocalFilename, *LockFile.LockUser);
-		OutLocks.Add(MoveTemp(LockFile.LocalFilename), MoveTemp(LockFile.LockUser));
+		OutFiles.Add(FPaths::ConvertRelativePathToFull(InRepositoryRoot, InFile));
+	}, ErrorMessages);
+	// Errors are expected if there is no upstream branch, so they are reported only if the branch was read to have one
+	if(!bResult && bKnownUpstream)
+	{
+		OutErrorMessages.Append(ErrorMessages);
+		return false;
 	}
+	return true;
+}
 
-	return bResult;
+bool RunFetch(const FString& InPathToGitBinary, const FString& InRepositoryRoot, TArray<FString>& OutErrorMessages)
+{
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	if(!GitSourceControl.GetProvider().TryStartFetch(GitSourceControlConstants::MinFetchInterval))
+	{
+		UE_LOG(LogSourceControl, Log, TEXT("RunFetch: skipped, last fetch less than %.0f seconds ago"), GitSourceControlConstants::MinFetchInterval);
+		return true;
+	}
+
+	TArray<FString> InfoMessages;
+	TArray<FString> Parameters;
+	Parameters.Add(TEXT("--quiet"));
+	return RunCommand(TEXT("fetch"), InPathToGitBinary, InRepositoryRoot, Parameters, TArray<FString>(), InfoMessages, OutErrorMessages);
+}
+
+/** Remove duplicated paths, and paths inside of one of the directories of the list */
+static void RemoveRedundantPaths(TArray<FString>& InOutPaths)
+{
+	const TSet<FString> UniquePaths(InOutPaths);
+	InOutPaths = UniquePaths.Array();
+	InOutPaths.RemoveAll([&UniquePaths](const FString& InPath) { return IsInDirectories(InPath, UniquePaths); });
 }
 
-// Run a batch of Git "status" command to update status of given files and/or directories.
+// Run a single repository-wide Git "status" command to update status of given files and/or directories.
 bool RunUpdateStatus(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InFiles, TArray<FString>& OutErrorMessages, TArray<FGitSourceControlState>& OutStates)
 {
 	bool bResults = true;
 	TMap<FString, FString> LockedFiles;
 
-	// 0) Issue a "git lfs locks" command at the root of the repository
+	// 0) Get the Git LFS locks of the repository (from the cache of the provider), reporting the failure of the lock server to tell it apart from "no locks"
 	if(InUsingLfsLocking)
 	{
-		TArray<FString> ErrorMessages;
-		GetAllLocks(InPathToGitBinary, InRepositoryRoot, true, ErrorMessages, LockedFiles);
+		bResults &= GetAllLocks(InPathToGitBinary, InRepositoryRoot, true, OutErrorMessages, LockedFiles);
 	}
 
-	// Git status does not show any "untracked files" when called with files from different subdirectories! (issue #3)
-	// 1) So here we group files by path (ie. by subdirectory)
+	// 1) Sort out directories (the "Submit to Source Control" menu) from files, and group files by path (ie. by subdirectory)
+	TArray<FString> Directories;
 	TMap<FString, TArray<FString>> GroupOfFiles;
 	for(const auto& File : InFiles)
 	{
-		const FString Path = FPaths::GetPath(*File);
-		TArray<FString>* Group = GroupOfFiles.Find(Path);
-		if(Group != nullptr)
+		if(FPaths::DirectoryExists(File))
 		{
-			Group->Add(File);
+			Directories.Add(File);
 		}
 		else
 		{
-			TArray<FString> NewGroup;
-			NewGroup.Add(File);
-			GroupOfFiles.Add(Path, NewGroup);
+			GroupOfFiles.FindOrAdd(FPaths::GetPath(File)).Add(File);
 		}
 	}
 
-	// Get the current branch name, since we need origin of current branch
-	FString BranchName;
-	GitSourceControlUtils::GetBranchName(InPathToGitBinary, InRepositoryRoot, BranchName);
-
-	TArray<FString> Parameters;
-	Parameters.Add(TEXT("--porcelain"));
-	Parameters.Add(TEXT("--ignored"));
-
-	// 2) then we can batch git status operation by subdirectory
-	for(const auto& Files : GroupOfFiles)
+	// "git status" can only detect renamed and deleted files when it operate on a folder, so use the folder of the files
+	TArray<FString> StatusPaths = Directories;
+	TArray<FString> Files;
+	for(const auto& Group : GroupOfFiles)
 	{
-		// "git status" can only detect renamed and deleted files when it operate on a folder, so use one folder path for all files in a directory
-		const FString Path = FPaths::GetPath(*Files.Value[0]);
-		TArray<FString> OnePath;
 		// Only one file: optim very useful for the .uproject file at the root to avoid parsing the whole repository
 		// (works only if the file exists)
-		if((Files.Value.Num() == 1) && (FPaths::FileExists(Files.Value[0])))
+		if((Group.Value.Num() == 1) && (FPaths::FileExists(Group.Value[0])))
 		{
-			OnePath.Add(Files.Value[0]);
+			StatusPaths.Add(Group.Value[0]);
 		}
 		else
 		{
-			OnePath.Add(Path);
+			StatusPaths.Add(Group.Key);
 		}
+		Files.Append(Group.Value);
+	}
+	// Each path given to "git status" makes it scan again, so remove those already covered by a parent directory
+	RemoveRedundantPaths(StatusPaths);
+
+	// 2) Then a single "git status" for the union of all these paths, its results being partitioned below into per-file states
+	TArray<FGitStatusRecord> Results;
+	if(StatusPaths.Num() > 0)
+	{
+		TArray<FString> ErrorMessages;
+		const bool bResult = RunStatus(InPathToGitBinary, InRepositoryRoot, StatusPaths, ErrorMessages, Results);
+		OutErrorMessages.Append(ErrorMessages);
+		if(bResult)
 		{
-			TArray<FString> Results;
-			TArray<FString> ErrorMessages;
-			const bool bResult = RunCommand(TEXT("status"), InPathToGitBinary, InRepositoryRoot, Parameters, OnePath, Results, ErrorMessages);
-			OutErrorMessages.Append(ErrorMessages);
-			if(bResult)
+			// 2.a) Special case for "status" of directories: requires to get the list of files by ourselves.
+			if(Directories.Num() > 0)
 			{
-				ParseStatusResults(InPathToGitBinary, InRepositoryRoot, InUsingLfsLocking, Files.Value, LockedFiles, Results, OutStates);
+				// TODO LFS Debug Log
+				UE_LOG(LogSourceControl, Log, TEXT("RunUpdateStatus: special case for status of %d directories (%s, ...)"), Directories.Num(), *Directories[0]);
+				TArray<FString> FilesInDirectories;
+				if(ListFilesInDirectories(InPathToGitBinary, InRepositoryRoot, Directories, FilesInDirectories))
+				{
+					Files.Append(MoveTemp(FilesInDirectories));
+				}
 			}
-		}
 
-		if (!BranchName.IsEmpty())
-		{
-			// Using git diff, we can obtain a list of files that were modified between our current origin and HEAD. Assumes that fetch has been run to get accurate info.
-			// TODO: should do a fetch (at least periodically).
-			TArray<FString> Results;
-			TArray<FString> ErrorMessages;
-			TArray<FString> ParametersLsRemote;
-			ParametersLsRemote.Add(TEXT("origin"));
-			ParametersLsRemote.Add(BranchName);
-			const bool bResultLsRemote = RunCommand(TEXT("ls-remote"), InPathToGitBinary, InRepositoryRoot, ParametersLsRemote, OnePath, Results, ErrorMessages);
-			// If the command is successful and there is only 1 line on the output the branch exists on remote
-			const bool bDiffAgainstRemote = bResultLsRemote && Results.Num();
-
-			Results.Reset();
-			ErrorMessages.Reset();
-			TArray<FString> ParametersLog;
-			ParametersLog.Add(TEXT("--pretty=")); // this omits the commit lines, just gets us files
-			ParametersLog.Add(TEXT("--name-only"));
-			ParametersLog.Add(bDiffAgainstRemote ? TEXT("HEAD..HEAD@{upstream}") : BranchName);
-			const bool bResultDiff = RunCommand(TEXT("log"), InPathToGitBinary, InRepositoryRoot, ParametersLog, OnePath, Results, ErrorMessages);
-			OutErrorMessages.Append(ErrorMessages);
-			if (bResultDiff)
-			{
-				for (const FString& NewerFileName : Results)
-				{
-					const FString NewerFilePath = FPaths::ConvertRelativePathToFull(InRepositoryRoot, NewerFileName);
+			// 2.b) General case for files
+			ParseFileStatusResult(InPathToGitBinary, InRepositoryRoot, InUsingLfsLocking, Files, LockedFiles, Results, OutStates);
 
-					// Find existing corresponding file state to update it (not found would mean new file or not in the current path)
-					if (FGitSourceControlState* FileStatePtr = OutStates.FindByPredicate([NewerFilePath](FGitSourceControlState& FileState) { return FileState.LocalFilename == NewerFilePath; }))
-					{
-						FileStatePtr->bNewerVersionOnServer = true;
-					}
-				}
+			// 2.c) The above cannot detect deleted assets since there is no file left to enumerate (either by the Content Browser or by git ls-files)
+			// => so we also parse the status results to explicitly look for Deleted/Missing assets in the directories
+			if(Directories.Num() > 0)
+			{
+				ParseDirectoryStatusResult(InPathToGitBinary, InRepositoryRoot, InUsingLfsLocking, TSet<FString>(Directories), TSet<FString>(Files), Results, OutStates);
 			}
 		}
 	}
 
+	// 3) Then, once for all files, look for newer versions on the server, from the remote-tracking branch as of the last fetch (without contacting the server)
+	TSet<FString> NewerFiles;
+	bResults &= GetFilesChangedUpstream(InPathToGitBinary, InRepositoryRoot, OutErrorMessages, NewerFiles);
+	if(NewerFiles.Num() > 0)
+	{
+		for(FGitSourceControlState& FileState : OutStates)
+		{
+			FileState.bNewerVersionOnServer = NewerFiles.Contains(FileState.LocalFilename);
+		}
+	}
+
 	return bResults;
 }
 
-// Run a Git `cat-file --filters` command to dump the binary content of a revision into a file.
-bool RunDumpToFile(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InParameter, const FString& InDumpFileName)
+// Run a single Git "status" command on some directories, to update only the files changed since a previous status of all their files.
+bool RunUpdateStatusChanges(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InDirectories, const TArray<FString>& InKnownFiles, TArray<FString>& OutErrorMessages, TArray<FGitSourceControlState>& OutStates)
 {
-	int32 ReturnCode = -1;
-	FString FullCommand;
+	const TSet<FString> Directories(InDirectories);
 
-	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
-	const FGitVersion& GitVersion = GitSourceControl.GetProvider().GetGitVersion();
+	// The files to update: those that were not unchanged...
+	TSet<FString> Files;
+	for(const FString& File : InKnownFiles)
+	{
+		Files.Add(File);
+	}
 
-	if(!InRepositoryRoot.IsEmpty())
+	// ... those that are locked (reporting the failure of the lock server to tell it apart from "no locks"), ...
+	bool bResults = true;
+	TMap<FString, FString> LockedFiles;
+	if(InUsingLfsLocking)
 	{
-		// Specify the working copy (the root) of the git repository (before the command itself)
-		FullCommand  = TEXT("-C \"");
-		FullCommand += InRepositoryRoot;
-		FullCommand += TEXT("\" ");
+		bResults &= GetAllLocks(InPathToGitBinary, InRepositoryRoot, true, OutErrorMessages, LockedFiles);
+		for(const auto& LockedFile : LockedFiles)
+		{
+			if(IsInDirectories(LockedFile.Key, Directories))
+			{
+				Files.Add(LockedFile.Key);
+			}
+		}
+	}
+
+	// ... those that have a newer version on the server, ...
+	TSet<FString> NewerFiles;
+	bResults &= GetFilesChangedUpstream(InPathToGitBinary, InRepositoryRoot, OutErrorMessages, NewerFiles);
+	for(const FString& NewerFile : NewerFiles)
+	{
+		if(IsInDirectories(NewerFile, Directories))
+		{
+			Files.Add(NewerFile);
+		}
+	}
+
+	// ... and those that are changed now (without listing all the files of the directories with "git ls-files")
+	TArray<FGitStatusRecord> Results;
+	TArray<FString> ErrorMessages;
+	TArray<FString> StatusPaths = InDirectories;
+	RemoveRedundantPaths(StatusPaths);
+	const bool bResult = RunStatus(InPathToGitBinary, InRepositoryRoot, StatusPaths, ErrorMessages, Results);
+	OutErrorMessages.Append(ErrorMessages);
+	if(!bResult)
+	{
+		return false;
+	}
+	for(const FGitStatusRecord& Result : Results)
+	{
+		if(!Result.Filename.EndsWith(TEXT("/")))
+		{
+			const FString File = FPaths::ConvertRelativePathToFull(InRepositoryRoot, Result.Filename);
+			if(IsInDirectories(File, Directories))
+			{
+				Files.Add(File);
+			}
+		}
 	}
 
-	// then the git command itself
-	if(GitVersion.bHasCatFileWithFilters)
+	ParseFileStatusResult(InPathToGitBinary, InRepositoryRoot, InUsingLfsLocking, Files.Array(), LockedFiles, Results, OutStates);
+	for(FGitSourceControlState& FileState : OutStates)
+	{
+		FileState.bNewerVersionOnServer = NewerFiles.Contains(FileState.LocalFilename);
+	}
+
+	return bResults;
+}
+
+// Launch a Git `cat-file --filters` command to get the binary content of a revision (fall-back used only if the long-lived `cat-file --batch` process fails).
+static bool RunDumpToBuffer(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bInWithFilters, const FString& InParameter, TArray<uint8>& OutContent)
+{
+	FString CommandLine;
+	if(bInWithFilters)
 	{
 		// Newer versions (2.9.3.windows.2) support smudge/clean filters used by Git LFS, git-fat, git-annex, etc
-		FullCommand += TEXT("cat-file --filters ");
+		CommandLine = TEXT("cat-file --filters ");
 	}
 	else
 	{
 		// Previous versions fall-back on "git show" like before
-		FullCommand += TEXT("show ");
+		CommandLine = TEXT("show ");
 	}
-
 	// Append to the command the parameter
-	FullCommand += InParameter;
+	CommandLine += InParameter;
 
-	const bool bLaunchDetached = false;
-	const bool bLaunchHidden = true;
-	const bool bLaunchReallyHidden = bLaunchHidden;
+	UE_LOG(LogSourceControl, Log, TEXT("RunDumpToFile: 'git %s'"), *CommandLine);
 
-	void* PipeRead = nullptr;
-	void* PipeWrite = nullptr;
-
-	verify(FPlatformProcess::CreatePipe(PipeRead, PipeWrite));
-
-	UE_LOG(LogSourceControl, Log, TEXT("RunDumpToFile: 'git %s'"), *FullCommand);
-
-    FString PathToGitOrEnvBinary = InPathToGitBinary;
-    #if PLATFORM_MAC
-        // The Cocoa application does not inherit shell environment variables, so add the path expected to have git-lfs to PATH
-        FString PathEnv = FPlatformMisc::GetEnvironmentVariable(TEXT("PATH"));
-        FString GitInstallPath = FPaths::GetPath(InPathToGitBinary);
-
-        TArray<FString> PathArray;
-        PathEnv.ParseIntoArray(PathArray, FPlatformMisc::GetPathVarDelimiter());
-        bool bHasGitInstallPath = false;
-        for (auto Path : PathArray)
-        {
-            if (GitInstallPath.Equals(Path, ESearchCase::CaseSensitive))
-            {
-                bHasGitInstallPath = true;
-                break;
-            }
-        }
-
-        if (!bHasGitInstallPath)
-        {
-            PathToGitOrEnvBinary = FString("/usr/bin/env");
-            FullCommand = FString::Printf(TEXT("PATH=\"%s%s%s\" \"%s\" %s"), *GitInstallPath, FPlatformMisc::GetPathVarDelimiter(), *PathEnv, *InPathToGitBinary, *FullCommand);
-        }
-    #endif
-    
-	FProcHandle ProcessHandle = FPlatformProcess::CreateProc(*PathToGitOrEnvBinary, *FullCommand, bLaunchDetached, bLaunchHidden, bLaunchReallyHidden, nullptr, 0, *InRepositoryRoot, PipeWrite);
-	if(ProcessHandle.IsValid())
+	if(FGitSourceControlCommand::IsCurrentCommandInterrupted())
 	{
-		FPlatformProcess::Sleep(0.01);
+		return false;
+	}
 
-		TArray<uint8> BinaryFileContent;
-		while(FPlatformProcess::IsProcRunning(ProcessHandle))
-		{
-			TArray<uint8> BinaryData;
-			FPlatformProcess::ReadPipeToArray(PipeRead, BinaryData);
-			if(BinaryData.Num() > 0)
-			{
-				BinaryFileContent.Append(MoveTemp(BinaryData));
-			}
-		}
-		TArray<uint8> BinaryData;
-		FPlatformProcess::ReadPipeToArray(PipeRead, BinaryData);
-		if(BinaryData.Num() > 0)
+	FGitProcessWatchdog Watchdog(CommandLine, TArray<FString>());
+	FGitProcess Process;
+	if(!Process.Launch(InPathToGitBinary, InRepositoryRoot, CommandLine))
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to launch 'git cat-file'"));
+		return false;
+	}
+	FGitScopedRunningProcess ScopedRunningProcess(Process);
+
+	FString Errors;
+	while(Process.IsRunning())
+	{
+		// Also drain the standard error (warnings of smudge filters like Git LFS), else Git would block on a full pipe
+		const FString NewErrors = Process.ReadStdErr();
+		Errors += NewErrors;
+		const bool bRead = Process.ReadStdOut(OutContent);
+		Watchdog.Check(Process, bRead || !NewErrors.IsEmpty());
+		if(!bRead)
 		{
-			BinaryFileContent.Append(MoveTemp(BinaryData));
+			FPlatformProcess::Sleep(0.001f);
 		}
+	}
+	Process.ReadStdOut(OutContent);
+	Errors += Process.ReadStdErr();
+	if(!Errors.IsEmpty())
+	{
+		UE_LOG(LogSourceControl, Warning, TEXT("DumpToFile: %s"), *Errors.TrimEnd());
+	}
+
+	if(Watchdog.HasTimedOut())
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("DumpToFile: %s"), *Watchdog.GetErrorMessage());
+		return false;
+	}
+
+	const int32 ReturnCode = Process.GetReturnCode();
+	if(ReturnCode != 0)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("DumpToFile: ReturnCode=%d"), ReturnCode);
+	}
+
+	return (ReturnCode == 0);
+}
+
+// Get the binary content of a revision from the long-lived `cat-file --batch` process of the provider, and dump it into a file.
+bool RunDumpToFile(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InParameter, const FString& InDumpFileName)
+{
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	FGitSourceControlProvider& Provider = GitSourceControl.GetProvider();
+	const bool bWithFilters = Provider.GetGitVersion().bHasCatFileWithFilters;
+
+	TArray<uint8> BinaryFileContent;
+	bool bResult = Provider.GetCatFileBatch().GetBlobContent(InPathToGitBinary, InRepositoryRoot, bWithFilters, InParameter, BinaryFileContent);
+	if(!bResult)
+	{
+		BinaryFileContent.Reset();
+		bResult = RunDumpToBuffer(InPathToGitBinary, InRepositoryRoot, bWithFilters, InParameter, BinaryFileContent);
+	}
 
-		FPlatformProcess::GetProcReturnCode(ProcessHandle, &ReturnCode);
-		if(ReturnCode == 0)
+	if(bResult)
+	{
+		// Save buffer into temp file
+		if(FFileHelper::SaveArrayToFile(BinaryFileContent, *InDumpFileName))
 		{
-			// Save buffer into temp file
-			if(FFileHelper::SaveArrayToFile(BinaryFileContent, *InDumpFileName))
-			{
-				UE_LOG(LogSourceControl, Log, TEXT("Writed '%s' (%do)"), *InDumpFileName, BinaryFileContent.Num());
-			}
-			else
-			{
-				UE_LOG(LogSourceControl, Error, TEXT("Could not write %s"), *InDumpFileName);
-				ReturnCode = -1;
-			}
+			UE_LOG(LogSourceControl, Log, TEXT("Writed '%s' (%do)"), *InDumpFileName, BinaryFileContent.Num());
 		}
 		else
 		{
-			UE_LOG(LogSourceControl, Error, TEXT("DumpToFile: ReturnCode=%d"), ReturnCode);
+			UE_LOG(LogSourceControl, Error, TEXT("Could not write %s"), *InDumpFileName);
+			bResult = false;
 		}
-
-		FPlatformProcess::CloseProc(ProcessHandle);
-	}
-	else
-	{
-		UE_LOG(LogSourceControl, Error, TEXT("Failed to launch 'git cat-file'"));
 	}
 
-	FPlatformProcess::ClosePipe(PipeRead, PipeWrite);
-
-	return (ReturnCode == 0);
+	return bResult;
 }
 
 /**
@@ -1316,7 +2494,7 @@ static FString LogStatusToString(TCHAR InStatus)
 }
 
 /**
- * Parse the array of strings results of a 'git log' command
+ * Parse the results of a 'git log' command, line by line
  *
  * Example git log results:
 commit 97a4e7626681895e073aaefd68b8ac087db81b0b
@@ -1341,17 +2519,24 @@ Date:   2014-2015-05-12 11:28:14 +0200
 A	Content/Blueprints/Blueprint_CeilingLight.uasset
 C099	Content/Textures/T_Concrete_Poured_N.uasset Content/Textures/T_Concrete_Poured_N2.uasset
 */
-static void ParseLogResults(const TArray<FString>& InResults, TGitSourceControlHistory& OutHistory)
+class FGitLogParser
 {
-	TSharedRef<FGitSourceControlRevision, ESPMode::ThreadSafe> SourceControlRevision = MakeShareable(new FGitSourceControlRevision);
-	for(const auto& Result : InResults)
+public:
+	FGitLogParser(TGitSourceControlHistory& InOutHistory)
+		: History(InOutHistory)
+		, SourceControlRevision(MakeShareable(new FGitSourceControlRevision))
+	{
+	}
+
+	/** Parse one line of the log, as soon as it is read from the Git process */
+	void ParseLine(const FString& Result)
 	{
 		if(Result.StartsWith(TEXT("commit "))) // Start of a new commit
 		{
 			// End of the previous commit
 			if(SourceControlRevision->RevisionNumber != 0)
 			{
-				OutHistory.Add(MoveTemp(SourceControlRevision));
+				History.Add(MoveTemp(SourceControlRevision));
 
 				SourceControlRevision = MakeShareable(new FGitSourceControlRevision);
 			}
@@ -1375,7 +2560,7 @@ static void ParseLogResults(const TArray<FString>& InResults, TGitSourceControlH
 			FString Date = Result.RightChop(8);
 			SourceControlRevision->Date = FDateTime::FromUnixTimestamp(FCString::Atoi(*Date));
 		}
-	//	else if(Result.IsEmpty()) // empty line before/after commit message has already been taken care by FString::ParseIntoArray()
+	//	else if(Result.IsEmpty()) // empty line before/after commit message has already been skipped by RunCommandStreamed()
 		else if(Result.StartsWith(TEXT("    ")))  // Multi-lines commit message
 		{
 			SourceControlRevision->Description += Result.RightChop(4);
@@ -1393,25 +2578,34 @@ static void ParseLogResults(const TArray<FString>& InResults, TGitSourceControlH
 			}
 		}
 	}
-	// End of the last commit
-	if(SourceControlRevision->RevisionNumber != 0)
-	{
-		OutHistory.Add(MoveTemp(SourceControlRevision));
-	}
 
-	// Then set the revision number of each Revision based on its index (reverse order since the log starts with the most recent change)
-	for(int32 RevisionIndex = 0; RevisionIndex < OutHistory.Num(); RevisionIndex++)
+	/** End of the log: add the last commit and number all revisions */
+	void Finish()
 	{
-		const auto& SourceControlRevisionItem = OutHistory[RevisionIndex];
-		SourceControlRevisionItem->RevisionNumber = OutHistory.Num() - RevisionIndex;
+		// End of the last commit
+		if(SourceControlRevision->RevisionNumber != 0)
+		{
+			History.Add(MoveTemp(SourceControlRevision));
+		}
 
-		// Special case of a move ("branch" in Perforce term): point to the previous change (so the next one in the order of the log)
-		if((SourceControlRevisionItem->Action == "branch") && (RevisionIndex < OutHistory.Num() - 1))
+		// Then set the revision number of each Revision based on its index (reverse order since the log starts with the most recent change)
+		for(int32 RevisionIndex = 0; RevisionIndex < History.Num(); RevisionIndex++)
 		{
-			SourceControlRevisionItem->BranchSource = OutHistory[RevisionIndex + 1];
+			const auto& SourceControlRevisionItem = History[RevisionIndex];
+			SourceControlRevisionItem->RevisionNumber = History.Num() - RevisionIndex;
+
+			// Special case of a move ("branch" in Perforce term): point to the previous change (so the next one in the order of the log)
+			if((SourceControlRevisionItem->Action == "branch") && (RevisionIndex < History.Num() - 1))
+			{
+				SourceControlRevisionItem->BranchSource = History[RevisionIndex + 1];
+			}
 		}
 	}
-}
+
+private:
+	TGitSourceControlHistory& History;
+	TSharedRef<FGitSourceControlRevision, ESPMode::ThreadSafe> SourceControlRevision; ///< Revision being parsed
+};
 
 /**
  * Extract the SHA1 identifier and size of a blob (file) from a Git "ls-tree" command.
@@ -1444,12 +2638,11 @@ bool RunGetHistory(const FString& InPathToGitBinary, const FString& InRepository
 {
 	bool bResults;
 	{
-		TArray<FString> Results;
 		TArray<FString> Parameters;
 		Parameters.Add(TEXT("--follow")); // follow file renames
 		Parameters.Add(TEXT("--date=raw"));
 		Parameters.Add(TEXT("--name-status")); // relative filename at this revision, preceded by a status character
-		Parameters.Add(TEXT("--pretty=medium")); // make sure format matches expected in ParseLogResults
+		Parameters.Add(TEXT("--pretty=medium")); // make sure format matches expected in FGitLogParser
 		if(bMergeConflict)
 		{
 			// In case of a merge conflict, we also need to get the tip of the "remote branch" (MERGE_HEAD) before the log of the "current branch" (HEAD)
@@ -1459,14 +2652,32 @@ bool RunGetHistory(const FString& InPathToGitBinary, const FString& InRepository
 		}
 		TArray<FString> Files;
 		Files.Add(*InFile);
-		bResults = RunCommand(TEXT("log"), InPathToGitBinary, InRepositoryRoot, Parameters, Files, Results, OutErrorMessages);
-		if(bResults)
+		FGitLogParser LogParser(OutHistory);
+		bResults = RunCommandStreamed(TEXT("log"), InPathToGitBinary, InRepositoryRoot, Parameters, Files, TEXT('\n'), [&LogParser](const FString& InLine)
 		{
-			ParseLogResults(Results, OutHistory);
-		}
+			LogParser.ParseLine(InLine);
+		}, OutErrorMessages);
+		LogParser.Finish();
 	}
+	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>("GitSourceControl");
+	FGitCatFileBatch& CatFileBatchCheck = GitSourceControl.GetProvider().GetCatFileBatchCheck();
 	for(auto& Revision : OutHistory)
 	{
+		// Get file (blob) sha1 id and size from the long-lived "cat-file --batch-check" process instead of launching one "ls-tree" per revision
+		const FString ObjectName = FString::Printf(TEXT("%s:%s"), *Revision->CommitId, *Revision->GetFilename());
+		FString ObjectId;
+		FString ObjectType;
+		int64 ObjectSize = 0;
+		if(CatFileBatchCheck.GetObjectInfo(InPathToGitBinary, InRepositoryRoot, ObjectName, ObjectId, ObjectType, ObjectSize))
+		{
+			if(!ObjectId.IsEmpty())
+			{
+				Revision->FileHash = ObjectId;
+				Revision->FileSize = static_cast<int32>(ObjectSize);
+			}
+			continue;
+		}
+
 		// Get file (blob) sha1 id and size
 		TArray<FString> Results;
 		TArray<FString> Parameters;
@@ -1519,8 +2730,17 @@ TArray<FString> AbsoluteFilenames(const TArray<FString>& InFileNames, const FStr
 	return AbsFiles;
 }
 
-bool UpdateCachedStates(const TArray<FGitSourceControlState>& InStates)
+bool UpdateCachedStates(TArray<FGitSourceControlState>& InOutStates)
 {
+	// Time spent applying states per tick, and number of states applied between two checks of the time
+	static const double TimeBudget = 0.005;
+	static const int32 StatesPerCheck = 256;
+
+	if(InOutStates.Num() == 0)
+	{
+		return false;
+	}
+
 	FGitSourceControlModule& GitSourceControl = FModuleManager::GetModuleChecked<FGitSourceControlModule>( "GitSourceControl" );
 	FGitSourceControlProvider& Provider = GitSourceControl.GetProvider();
 	const bool bUsingGitLfsLocking = GitSourceControl.AccessSettings().IsUsingGitLfsLocking();
@@ -1528,14 +2748,27 @@ bool UpdateCachedStates(const TArray<FGitSourceControlState>& InStates)
 	// TODO without LFS : Workaround a bug with the Source Control Module not updating file state after a simple "Save" with no "Checkout" (when not using File Lock)
 	const FDateTime Now = bUsingGitLfsLocking ? FDateTime::Now() : FDateTime();
 
-	for(const auto& InState : InStates)
+	// Apply the states from the end of the array, so that removing them is free
+	const double StartTime = FPlatformTime::Seconds();
+	int32 NumApplied = 0;
+	while(InOutStates.Num() > 0)
+	{
+		Provider.UpdateStateInternal(InOutStates.Pop(false), Now);
+		if((++NumApplied % StatesPerCheck == 0) && (FPlatformTime::Seconds() - StartTime > TimeBudget))
+		{
+			break;
+		}
+	}
+	if(InOutStates.Num() > 0)
+	{
+		UE_LOG(LogSourceControl, Verbose, TEXT("UpdateCachedStates: %d states applied, %d left for the next tick"), NumApplied, InOutStates.Num());
+	}
+	else
 	{
-		TSharedRef<FGitSourceControlState, ESPMode::ThreadSafe> State = Provider.GetStateInternal(InState.LocalFilename);
-		*State = InState;
-		State->TimeStamp = Now;
+		InOutStates.Empty();
 	}
 
-	return (InStates.Num() > 0);
+	return true;
 }
 
 /**
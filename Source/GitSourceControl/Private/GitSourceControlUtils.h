@@ -31,6 +31,65 @@ private:
 	FString Filename;
 };
 
+/**
+ * Helper class to launch a Git process with its standard streams redirected to pipes,
+ * so that its output can be read while it is running, and its standard input written to.
+ */
+class FGitProcess
+{
+public:
+
+	/** Destructor - terminate the process if still running, and close all pipes */
+	~FGitProcess();
+
+	/**
+	 * Launch the Git process
+	 * @param	InPathToGitBinary	The path to the Git binary
+	 * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory (can be empty)
+	 * @param	InCommandLine		The Git command followed by its parameters - e.g. "cat-file --batch"
+	 * @param	bInWithStdIn		Open a pipe to write to the standard input of the process
+	 * @returns true if the process was launched
+	 */
+	bool Launch(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const FString& InCommandLine, const bool bInWithStdIn = false);
+
+	/** Tell if the process is still running */
+	bool IsRunning();
+
+	/** Write raw bytes to the standard input of the process (blocking until everything is written, or the process exits) */
+	bool WriteStdIn(const uint8* InData, const int32 InDataLength);
+
+	/** Write a string (encoded as UTF-8) to the standard input of the process */
+	bool WriteStdIn(const FString& InString);
+
+	/** Close the standard input of the process so that it reads an end-of-file */
+	void CloseStdIn();
+
+	/** Append any bytes available on the standard output of the process - never blocks
+	 * @returns true if some bytes were read */
+	bool ReadStdOut(TArray<uint8>& OutData);
+
+	/** Read any text available on the standard error of the process - never blocks (always empty when redirected to the standard output, before UE5.1) */
+	FString ReadStdErr();
+
+	/** Get the return code of the process, once it is not running anymore */
+	int32 GetReturnCode();
+
+	/** Terminate the process, and all its child processes */
+	void Terminate();
+
+private:
+	/** Handle to the Git process */
+	FProcHandle ProcessHandle;
+
+	/** Pipes redirecting the standard streams of the process */
+	void* StdOutRead = nullptr;
+	void* StdOutWrite = nullptr;
+	void* StdErrRead = nullptr;
+	void* StdErrWrite = nullptr;
+	void* StdInRead = nullptr;
+	void* StdInWrite = nullptr;
+};
+
 struct FGitVersion;
 
 namespace GitSourceControlUtils
@@ -129,8 +188,37 @@ bool GetRemoteUrl(const FString& InPathToGitBinary, const FString& InRepositoryR
  * @returns true if the command succeeded and returned no errors
  */
 bool RunCommand(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, TArray<FString>& OutResults, TArray<FString>& OutErrorMessages);
+
+/**
+ * Run a Git command (ie. add or rm) for the files of a command gathering several batched operations (see FGitSourceControlProvider::IssueBatchedCommand()).
+ * If it fails, run it again for the files of each operation, so that each operation gets its own result and messages (see FGitMergedOperation).
+ *
+ * @param	InCommand			The Git command - e.g. add
+ * @param	InOutCommand		The source control command, to which the results are added
+ * @returns true if the command succeeded for the operation of the command itself (or for all of them if it did not fail)
+ */
+bool RunBatchedCommand(const FString& InCommand, FGitSourceControlCommand& InOutCommand);
 bool RunCommandInternalRaw(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, FString& OutResults, FString& OutErrors, const int32 ExpectedReturnCode = 0);
 
+/**
+ * Run a Git command, streaming its output: each line (or NUL-terminated record) is passed to a callback as soon as Git writes it,
+ * so that big outputs ("ls-files", "status", "log"...) are parsed while Git is still running, without buffering them.
+ *
+ * Empty records are skipped. Before UE5.1, the output is buffered (ExecProcess) to keep the standard error separated,
+ * and the "-z" option is replaced by lines with quoted filenames, that are unquoted into the same records.
+ *
+ * @param	InCommand			The Git command - e.g. status
+ * @param	InPathToGitBinary	The path to the Git binary
+ * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory (can be empty)
+ * @param	InParameters		The parameters to the Git command
+ * @param	InFiles				The files to be operated on
+ * @param	InDelimiter			The separator of records in the output: '\n' for lines, or '\0' for commands using the "-z" option
+ * @param	InCallback			Called on the calling thread for each record (the string is reused, so copy it to keep it)
+ * @param	OutErrorMessages	Any errors (from StdErr) as an array per-line
+ * @returns true if the command succeeded
+ */
+bool RunCommandStreamed(const FString& InCommand, const FString& InPathToGitBinary, const FString& InRepositoryRoot, const TArray<FString>& InParameters, const TArray<FString>& InFiles, const TCHAR InDelimiter, const TFunctionRef<void(const FString&)>& InCallback, TArray<FString>& OutErrorMessages);
+
 /**
  * Run a Git "commit" command by batches.
  *
@@ -156,7 +244,35 @@ bool RunCommit(const FString& InPathToGitBinary, const FString& InRepositoryRoot
 bool RunUpdateStatus(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InFiles, TArray<FString>& OutErrorMessages, TArray<FGitSourceControlState>& OutStates);
 
 /**
- * Run a Git "cat-file" command to dump the binary content of a revision into a file.
+ * Run a Git "status" command on some directories to update only the files changed since a previous status of all their files (ie. loaded from a snapshot)
+ *
+ * Files not listed anymore by the status are reported unchanged, without listing all the files of the directories with "git ls-files".
+ *
+ * @param	InPathToGitBinary	The path to the Git binary
+ * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
+ * @param	InUsingLfsLocking	Tells if using the Git LFS file Locking workflow
+ * @param	InDirectories		The directories to update
+ * @param	InKnownFiles		The files that were not unchanged (or were locked) in the previous status
+ * @param	OutErrorMessages	Any errors (from StdErr) as an array per-line
+ * @param	OutStates			States of the files that changed
+ * @returns true if the command succeeded and returned no errors
+ */
+bool RunUpdateStatusChanges(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool InUsingLfsLocking, const TArray<FString>& InDirectories, const TArray<FString>& InKnownFiles, TArray<FString>& OutErrorMessages, TArray<FGitSourceControlState>& OutStates);
+
+/**
+ * Run a Git "fetch" command to update the remote-tracking branches, unless the last one was less than a minute ago.
+ * This is the only step contacting the server to know about newer versions of files (see RunUpdateStatus()).
+ *
+ * @param	InPathToGitBinary	The path to the Git binary
+ * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
+ * @param	OutErrorMessages	Any errors (from StdErr) as an array per-line
+ * @returns true if the command succeeded (or was skipped)
+ */
+bool RunFetch(const FString& InPathToGitBinary, const FString& InRepositoryRoot, TArray<FString>& OutErrorMessages);
+
+/**
+ * Get the binary content of a revision from the long-lived "cat-file --batch" process of the provider
+ * (or else from a new Git "cat-file" command) to dump it into a file.
  *
  * @param	InPathToGitBinary	The path to the Git binary
  * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
@@ -195,10 +311,12 @@ TArray<FString> RelativeFilenames(const TArray<FString>& InFileNames, const FStr
 TArray<FString> AbsoluteFilenames(const TArray<FString>& InFileNames, const FString& InRelativeTo);
 
 /**
- * Helper function for various commands to update cached states.
+ * Helper function for various commands to update cached states, moving the new states into the cache.
+ * Applies them a slice at a time, within a time budget per tick, to avoid a hitch for large results: call it again while states remain.
+ * @param	InOutStates		The states to apply, from which the applied ones are removed
  * @returns true if any states were updated
  */
-bool UpdateCachedStates(const TArray<FGitSourceControlState>& InStates);
+bool UpdateCachedStates(TArray<FGitSourceControlState>& InOutStates);
 
 /**
  * Remove redundant errors (that contain a particular string) and also
@@ -207,14 +325,15 @@ bool UpdateCachedStates(const TArray<FGitSourceControlState>& InStates);
 void RemoveRedundantErrors(FGitSourceControlCommand& InCommand, const FString& InFilter);
 
 /**
- * Run 'git lfs locks" to extract all lock information for all files in the repository
+ * Get all lock information for all files in the repository, from the cache of the provider
+ * (refreshed in the background with "git lfs locks --json" when not fresh anymore)
  *
  * @param	InPathToGitBinary	The path to the Git binary
  * @param	InRepositoryRoot	The Git repository from where to run the command - usually the Game directory
  * @param   bAbsolutePaths      Whether to report absolute filenames, false for repo-relative
  * @param	OutErrorMessages    Any errors (from StdErr) as an array per-line
  * @param	OutLocks		    The lock results (file, username)
- * @returns true if the command succeeded and returned no errors
+ * @returns false if the last refresh of the locks from the server failed, with its errors (the locks are then the ones of the previous answer, if any)
  */
 bool GetAllLocks(const FString& InPathToGitBinary, const FString& InRepositoryRoot, const bool bAbsolutePaths, TArray<FString>& OutErrorMessages, TMap<FString, FString>& OutLocks);
 
@@ -22,9 +22,15 @@ public:
 
 	/**
 	 * Updates the state of any items after completion (if necessary). This is always executed on the main thread.
+	 * Large results are applied a slice at a time, within a time budget: called again on the next ticks while HasPendingStates().
 	 * @returns true if states were updated
 	 */
-	virtual bool UpdateStates() const = 0;
+	virtual bool UpdateStates() = 0;
+
+	/**
+	 * Tells if some results are still to be applied by the next calls to UpdateStates(), before completing the command.
+	 */
+	virtual bool HasPendingStates() const = 0;
 };
 
 typedef TSharedRef<IGitSourceControlWorker, ESPMode::ThreadSafe> FGitSourceControlWorkerRef;